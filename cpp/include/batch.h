@@ -0,0 +1,15 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+
+/**
+ * @brief Runs the whole pipeline for many edge lists on one shared work-stealing pool and I/O writer, and prints
+ * the throughput of every job.
+ *
+ * @param       path        A directory (every '.txt' in it) or a manifest file (one edge list per line, '#' comments)
+ * @param       external    Builds every '-graph.bin' out of core first, as with 'process -e'
+ */
+int process_batch(std::string path, bool external = false);
+
+#endif
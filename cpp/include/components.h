@@ -0,0 +1,41 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <vector>
+#include "graph.h"
+#include "force-directed-layout.h"
+
+/**
+ * @brief Labels every vertex with its connected component, the label being the smallest vertex id in it.
+ *
+ * @param       thread_nr   The number of threads used for the union-find, 0 uses one per hardware thread. Called
+ *                          from a pool worker, the pool is shared instead
+ */
+std::vector<node_int> connected_components(Graph* graph, unsigned thread_nr);
+/**
+ * @brief Groups the vertices by their component label, largest component first.
+ */
+std::vector<std::vector<node_int>> component_members(const std::vector<node_int>& labels);
+/**
+ * @brief Builds the subgraph induced by members, vertex i of it being members[i].
+ *
+ * @param       local_ids   Maps every vertex of graph to its index in the members of its component
+ * @param       communities Copies the community labels, otherwise every vertex is its own community. Only safe
+ *                          once the communities are final, see fdl_layout_components
+ */
+Graph* component_subgraph(Graph* graph, const std::vector<node_int>& members, const std::vector<node_int>& local_ids,
+                          bool communities = true);
+/**
+ * @brief Shelf packing: places the rectangles (width, height) row by row, tallest first, into a roughly square
+ * canvas, and returns the lower left corner of every rectangle.
+ */
+std::vector<std::pair<double,double>> pack_rectangles(const std::vector<std::pair<double,double>>& sizes);
+/**
+ * @brief Lays out every connected component on its own canvas, in parallel, and packs the results into fdl->pos.
+ *
+ * @param       recorder    If set, the components run their iterations in lockstep and the packed positions are
+ *                          recorded every stride
+ */
+void fdl_layout_components(FDL* fdl, Graph* graph, FrameRecorder* recorder = nullptr);
+
+#endif
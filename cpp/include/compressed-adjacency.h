@@ -0,0 +1,84 @@
+#ifndef COMPRESSED_ADJACENCY_H
+#define COMPRESSED_ADJACENCY_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+// Included from graph.h, after node_int and edge_int are defined.
+
+/**
+ * @brief Compressed alternative to the CSR targets. Every neighbour list is sorted, the first neighbour is
+ * stored as is and every following one as the gap to its predecessor, each as a little endian base-128 varint
+ * (7 bits per byte, the high bit marks that another byte follows).
+ *
+ * Since neighbour ids of a (reordered) graph tend to be close together, most gaps fit into a single byte. The
+ * start of every list is stored, so a walk decodes nothing but the requested list. With 16 bit node ids this index
+ * takes at most 512 KiB. Every list starts with its length as a varint, so a compressed graph needs neither the
+ * CSR offsets nor the degrees next to it.
+ */
+class CompressedAdjacency{
+    public:
+        CompressedAdjacency(){}
+        CompressedAdjacency(std::vector<uint64_t> byte_offsets, std::vector<uint8_t> bytes)
+            : byte_offsets(std::move(byte_offsets)), bytes(std::move(bytes)){}
+
+        /**
+         * @brief Calls f(neighbour) for every neighbour of id, in ascending order, decoding on the fly.
+         */
+        template<typename F> void for_each(node_int id, F f) const {
+            const uint8_t* it = bytes.data() + byte_offsets[id];
+            uint64_t count = get_varint(it);
+
+            uint32_t value = 0;
+            for(; count > 0; count--){
+                value += (uint32_t)get_varint(it);
+                f((node_int)value);
+            }
+        }
+        /**
+         * @brief The length of the neighbour list of id, read from its first varint.
+         */
+        uint64_t get_degree(node_int id) const {
+            const uint8_t* it = bytes.data() + byte_offsets[id];
+            return get_varint(it);
+        }
+
+        std::vector<uint64_t>& get_byte_offsets();
+        std::vector<uint8_t>& get_bytes();
+        size_t size_in_bytes() const;
+
+    private:
+        /**
+         * @brief Decodes the varint at it and moves it past it.
+         */
+        static uint64_t get_varint(const uint8_t*& it){
+            uint64_t value = 0;
+            int shift = 0;
+            uint8_t b;
+            do{
+                b = *it++;
+                value |= (uint64_t)(b & 0x7F) << shift;
+                shift += 7;
+            } while(b & 0x80);
+
+            return value;
+        }
+
+        // byte_offsets[v] is the position in bytes of the list of vertex v, byte_offsets[n] the size of bytes.
+        std::vector<uint64_t> byte_offsets;
+        std::vector<uint8_t> bytes;
+};
+
+/**
+ * @brief Encodes a CSR (neighbour lists do not have to be sorted) into a CompressedAdjacency.
+ */
+CompressedAdjacency compress_adjacency(const std::vector<edge_int>& offsets, const std::vector<node_int>& targets);
+/**
+ * @brief Appends the neighbour list of the next vertex to an adjacency being built, whose byte_offsets start out as
+ * {0}, e.g. while reading the lists from a file. Sorts neighbors in place.
+ */
+void append_neighbors(std::vector<uint64_t>& byte_offsets, std::vector<uint8_t>& bytes, std::vector<node_int>& neighbors);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef CONFIG_LOADER_H
+#define CONFIG_LOADER_H
+
+#include <string>
+
+/**
+ * @brief Sets a single value of config.h at runtime. Keys are the names of the values in lower case with dashes,
+ * e.g. 'fdl-max-iter' for fdl::FDL_MAX_ITER.
+ *
+ * @return      1 on success, 0 for an unknown key or a value that doesn't parse
+ */
+int config_set(std::string key, std::string value);
+/**
+ * @brief Reads 'key = value' lines, '#' starts a comment.
+ */
+int config_from_file(std::string file_name);
+/**
+ * @brief Applies the config file given by '--config <file>' first and then every '--key=value' flag, so flags
+ * override the file. All other arguments are left alone.
+ */
+int config_from_args(int argc, char* argv[]);
+/**
+ * @brief The seed to use, config::SEED or, if that is 0, one drawn from the clock once per run.
+ */
+unsigned config_seed();
+/**
+ * @brief Prints all values with their keys (in debug mode).
+ */
+void config_print();
+
+#endif
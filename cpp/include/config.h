@@ -1,35 +1,130 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <cstdint>
+#include <cstddef>
+
 extern bool DEBUG_MODE;
 
+// The values below are the defaults, every run can override them with a config file or flags (see config-loader.h).
+
 namespace config{
-    constexpr int MAX_PROP_ITER = 30;
-    constexpr int PROP_STEPS_PER_ITER = 1;
+    inline int MAX_PROP_ITER = 30;
+    inline int PROP_STEPS_PER_ITER = 1;
 
     // Ranking stuff
     /**
      * @brief The ranking algorithm currently selected.
      */
-    constexpr int RANKING_ALGORITHM = 2;
+    inline int RANKING_ALGORITHM = 2;
     /**
      * @brief The amount of iterations we want the ranking algorithm to go through. Only affects algorithms which
      * go through more than one iteration. (e.g. NEIGHBOURHOOD is not affected)
      */
-    constexpr int RANKING_ITERATIONS = 10;
+    inline int RANKING_ITERATIONS = 10;
+
+    /**
+     * @brief The vertex reordering applied to the CSR (see reorder_algorithm). Outputs always use the ids of the input file.
+     */
+    inline int REORDER_ALGORITHM = 0;
+    /**
+     * @brief Whether the CSR targets are kept delta + varint compressed (see CompressedAdjacency). Kernels decode
+     * the neighbour lists on the fly, the '-graph.bin' is written in the compressed format (version 0x02).
+     */
+    inline bool COMPRESS_ADJACENCY = false;
+
+    /**
+     * @brief The memory (in bytes) the external build ('-e') may use for its runs and merge buffers.
+     */
+    inline uint64_t EXTERNAL_MEMORY_BUDGET = 256ull * 1024 * 1024;
+    /**
+     * @brief The maximum number of runs merged at once by the external build. More runs get merged in several passes.
+     */
+    inline size_t EXTERNAL_MERGE_FANIN = 64;
+    /**
+     * @brief The memory (in bytes) a run should stay under, 0 for no limit. Under a budget the pipeline picks lower
+     * footprint strategies where it has to (see plan_memory).
+     */
+    inline uint64_t MEMORY_BUDGET = 0;
 
     constexpr int MAX_QUADTREE_DEPTH = 64;
+
+    /**
+     * @brief The number of worker threads of the 'process' pipeline, 0 uses one per hardware thread.
+     */
+    inline unsigned PIPELINE_THREADS = 0;
+
+    /**
+     * @brief The seed of everything random (start positions, label propagation ties), so that runs are reproducible.
+     * 0 draws a new seed from the clock every run.
+     */
+    inline unsigned SEED = 1;
+
+    /**
+     * @brief Whether the triangle counts and clustering coefficients are written to a '-clustering.bin'.
+     */
+    inline bool WRITE_CLUSTERING = false;
 }
 
 namespace fdl{
-    constexpr bool SHOW_ISOLATED_NODES_JSON = false;
-    constexpr bool INCLUDE_NEIGHBOURS_JSON = true;
-    constexpr bool INCLUDE_RANK_JSON = true;
-    constexpr int FDL_MAX_ITER = 250;
-    constexpr int WIDTH = 128;
-    constexpr int HEIGHT = 128;
-    constexpr double FDL_START_TEMP = fdl::HEIGHT/10;   // height/10 is just a heuristic, can be tweaked
-    constexpr double GRAVITY_STRENGTH = 0.01;
+    inline bool SHOW_ISOLATED_NODES_JSON = false;
+    inline bool INCLUDE_NEIGHBOURS_JSON = true;
+    inline bool INCLUDE_RANK_JSON = true;
+    inline bool INCLUDE_CLUSTERING_JSON = false;
+    inline int FDL_MAX_ITER = 250;
+    inline int WIDTH = 128;
+    inline int HEIGHT = 128;
+    inline double FDL_START_TEMP = fdl::HEIGHT/10;   // height/10 is just a heuristic, can be tweaked (follows HEIGHT unless set)
+    inline double GRAVITY_STRENGTH = 0.01;
+    /**
+     * @brief The initial_placement of the nodes before the first iteration.
+     */
+    inline int INITIAL_PLACEMENT = 1;
+    /**
+     * @brief The number of BFS pivots of the PIVOT_MDS placement.
+     */
+    inline int PIVOT_NR = 50;
+    /**
+     * @brief Starting from a placement other than RANDOM_PLACEMENT, the layout runs this many iterations instead of
+     * FDL_MAX_ITER, starting at FDL_START_TEMP times this factor.
+     */
+    inline int PLACED_MAX_ITER = 100;
+    inline double PLACED_START_TEMP_FACTOR = 0.25;
+    /**
+     * @brief Whether a '-spatial.bin' k-d tree over the final positions is written next to the layout.
+     */
+    inline bool WRITE_SPATIAL_INDEX = true;
+    /**
+     * @brief Whether the positions are recorded into a '-frames.bin' stream every RECORD_STRIDE iterations, for animating
+     * the layout (see python/src/frame-reader.py).
+     */
+    inline bool RECORD_FRAMES = false;
+    inline int RECORD_STRIDE = 5;
+    /**
+     * @brief The frame_precision of the recorded frames.
+     */
+    inline int RECORD_PRECISION = 2;
+    /**
+     * @brief Whether every connected component is laid out on its own (in parallel) and the results are packed
+     * into one canvas, instead of one layout over the whole graph.
+     */
+    inline bool LAYOUT_BY_COMPONENT = true;
+    /**
+     * @brief Components smaller than this are laid out together in one task, up to this many nodes per task.
+     */
+    inline int COMPONENT_BATCH_NODES = 256;
+    /**
+     * @brief The number of layouts (with consecutive seeds) per setting of the 'evaluate' command.
+     */
+    inline int EVALUATE_SEEDS = 3;
+    /**
+     * @brief The number of BFS sources of the sampled stress (see layout_quality).
+     */
+    inline int EVALUATE_SOURCES = 32;
+    /**
+     * @brief The number of vertices and edges sampled for the neighbourhood preservation and the crossings.
+     */
+    inline int EVALUATE_SAMPLES = 1000;
 }
 
 #endif
\ No newline at end of file
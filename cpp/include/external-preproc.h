@@ -0,0 +1,22 @@
+#ifndef EXTERNAL_PREPROC_H
+#define EXTERNAL_PREPROC_H
+
+#include <string>
+#include <cstdint>
+#include "graph.h"
+
+/**
+ * @brief The I/O volume of an external build, in bytes.
+ */
+struct external_io_stats{
+    uint64_t text_read = 0;
+    uint64_t runs_written = 0;
+    uint64_t runs_read = 0;
+    uint64_t graph_written = 0;
+    uint64_t run_nr = 0;
+    uint64_t merge_passes = 0;
+};
+
+int txt_to_bin_external(std::string dir, uint64_t memory_budget, external_io_stats* stats = nullptr);
+
+#endif
@@ -11,29 +11,53 @@
 #include <random>
 #include <ctime>
 #include <limits>
+#include <sstream>
 #include "graph.h"
 #include "config.h"
 #include "ranking.h"
+#include "frame-recorder.h"
+#include "memory-budget.h"
 
 class FDL{
     public:
-        FDL(std::vector<std::pair<double,double>> pos, std::vector<std::pair<double,double>> dis, std::vector<std::vector<node_int>> adj_matrix,
+        // The neighbours are read from the graph itself, the FDL only holds what grows with the vertices.
+        FDL(std::vector<std::pair<double,double>> pos, std::vector<std::pair<double,double>> dis,
             Graph* graph, const int width, const int height, const int area, const int max_iter, const double k, double temp) 
-            : pos(pos), dis(dis), adj_matrix(adj_matrix), graph(graph), width(width), height(height), area(area), max_iter(max_iter),
-            k(k), temp(temp){}
+            : pos(std::move(pos)), dis(std::move(dis)), graph(graph), width(width), height(height), area(area), max_iter(max_iter),
+            k(k), start_temp(temp), temp(temp){
+            memory_track(MEMORY_LAYOUT, this->tracked_bytes());
+        }
+        ~FDL(){
+            memory_track(MEMORY_LAYOUT, -this->tracked_bytes());
+        }
+        FDL(const FDL&) = delete;
+        FDL& operator=(const FDL&) = delete;
 
         std::vector<std::pair<double,double>> pos;
         std::vector<std::pair<double,double>> dis;
-        std::vector<std::vector<node_int>> adj_matrix;
         Graph* graph;
         const int width;
         const int height;
         const int area;
         const int max_iter;
         const double k;
+        const double start_temp;
         double temp;
+
+    private:
+        int64_t tracked_bytes(){
+            return (pos.capacity() + dis.capacity()) * sizeof(std::pair<double,double>);
+        }
 };
 
-void fdl_run(std::string file_name, Graph* graph);
+FDL *fdl_start(Graph* graph, bool by_component = fdl::LAYOUT_BY_COMPONENT);
+FDL *fdl_start(Graph* graph, int width, int height, bool by_component = false);
+void fdl_iteration(FDL *fdl, Graph* graph, int iteration);
+void fdl_layout(FDL* fdl, Graph* graph, FrameRecorder* recorder = nullptr, bool by_component = fdl::LAYOUT_BY_COMPONENT);
+std::string fdl_json_path(std::string file_name, int snapshot);
+void fdl_json(std::ostream& out, Graph* graph, const std::vector<std::pair<double,double>>& pos, const std::vector<node_int>& ranking,
+              const std::vector<double>& clustering = std::vector<double>());
+std::string fdl_json(Graph* graph, const std::vector<std::pair<double,double>>& pos, const std::vector<node_int>& ranking,
+                     const std::vector<double>& clustering = std::vector<double>());
 
 #endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef FRAME_RECORDER_H
+#define FRAME_RECORDER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "graph.h"
+
+enum frame_precision{
+    /**
+     * @brief Every frame is stored as 32 bit floats.
+     */
+    FRAME_FLOAT32,
+    /**
+     * @brief Every frame is stored as 16 bit (IEEE half precision) floats.
+     */
+    FRAME_FLOAT16,
+    /**
+     * @brief Frames are stored as 16 bit integer deltas to the previous frame with one scale per frame. Every
+     * FRAME_KEY_INTERVAL-th frame is a float32 key frame, so playback can seek and rounding errors can't pile up.
+     */
+    FRAME_DELTA16
+};
+
+/**
+ * @brief Records the positions of the layout every few iterations into a single '-frames.bin' stream.
+ *
+ * The layout thread only copies the positions into the back buffer of a double buffer; a background thread
+ * encodes and writes the front buffer. If the writer is still busy with the previous frame, the new frame is
+ * dropped instead of stalling the layout.
+ */
+class FrameRecorder{
+    public:
+        static constexpr int FRAME_KEY_INTERVAL = 32;
+
+        FrameRecorder(std::string file_name, Graph* graph, frame_precision precision, int stride);
+        ~FrameRecorder();
+
+        /**
+         * @brief Records the positions if iteration is a multiple of the stride. Never blocks on I/O.
+         *
+         * @param       last        Always record this frame (the final positions), waiting for the writer if needed
+         */
+        void record(int iteration, const std::vector<std::pair<double,double>>& pos, bool last = false);
+        /**
+         * @brief Writes the last pending frame and closes the stream.
+         */
+        void close();
+
+        int get_stride();
+        size_t get_recorded_nr();
+        size_t get_dropped_nr();
+
+    private:
+        void work();
+        void write_frame(int iteration, const std::vector<float>& frame);
+
+        Graph* graph;
+        frame_precision precision;
+        int stride;
+        std::ofstream file;
+
+        // The layout thread fills back, the writer swaps it with front once pending is set.
+        std::vector<float> front;
+        std::vector<float> back;
+        int back_iteration = 0;
+        bool pending = false;
+        bool stopping = false;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::thread worker;
+
+        // Only touched by the writer: the frame as the reader will reconstruct it, for the deltas.
+        std::vector<float> reconstructed;
+        size_t written_nr = 0;
+        size_t recorded_nr = 0;
+        size_t dropped_nr = 0;
+};
+
+#endif
@@ -3,8 +3,13 @@
 
 #include <vector>
 #include <cstdint>
+#include <utility>
 
 typedef uint16_t node_int;
+// Offsets and edge counts, which grow with the number of edges rather than the number of nodes.
+typedef uint64_t edge_int;
+
+#include "compressed-adjacency.h"
 
 enum graph_type{
     UNDIRECTED,
@@ -13,33 +18,121 @@ enum graph_type{
 
 class Graph{
     public:
-        Graph(graph_type graph_type, node_int edge_nr, node_int vertex_nr, std::vector<node_int> offsets, std::vector<node_int> targets, std::vector<node_int> degrees, std::vector<node_int> communities):
-        graph_type(graph_type), edge_nr(edge_nr), vertex_nr(vertex_nr), offsets(offsets), targets(targets), degrees(degrees), communities(communities){}
+        // The vectors are moved in, pass them with std::move to avoid copying the CSR.
+        Graph(graph_type type, edge_int edge_nr, node_int vertex_nr, std::vector<edge_int> offsets, std::vector<node_int> targets, std::vector<node_int> communities):
+        type(type), edge_nr(edge_nr), vertex_nr(vertex_nr), offsets(std::move(offsets)), targets(std::move(targets)), communities(std::move(communities)){
+            this->track_memory();
+        }
 
-        Graph(node_int edge_nr, node_int vertex_nr, std::vector<node_int> offsets, std::vector<node_int> targets, std::vector<node_int> degrees, std::vector<node_int> communities):
-        edge_nr(edge_nr), vertex_nr(vertex_nr), offsets(offsets), targets(targets), degrees(degrees), communities(communities){
-            this->graph_type = UNDIRECTED;
+        Graph(edge_int edge_nr, node_int vertex_nr, std::vector<edge_int> offsets, std::vector<node_int> targets, std::vector<node_int> communities):
+        edge_nr(edge_nr), vertex_nr(vertex_nr), offsets(std::move(offsets)), targets(std::move(targets)), communities(std::move(communities)){
+            this->type = UNDIRECTED;
+            this->track_memory();
         }
+
+        ~Graph();
+        // The size of a graph is accounted once (see memory_track), so it is never copied.
+        Graph(const Graph&) = delete;
+        Graph& operator=(const Graph&) = delete;
         
         graph_type get_graph_type();
-        node_int get_edge_nr();
+        edge_int get_edge_nr();
         node_int get_vertex_nr();
-        std::vector<node_int>& get_offsets();
+        /**
+         * @brief The CSR offsets, empty once the graph is compressed (see get_degree).
+         */
+        std::vector<edge_int>& get_offsets();
         std::vector<node_int>& get_targets();
-        std::vector<node_int>& get_degrees();
+        /**
+         * @brief The degree of every vertex, computed on every call as the graph doesn't store them.
+         */
+        std::vector<edge_int> get_degrees();
         std::vector<node_int>& get_communities();
 
         std::vector<node_int> get_neighbors(node_int id);
-        std::vector<std::vector<node_int>> get_adj_matrix();
+        edge_int get_degree(node_int id);
+
+        /**
+         * @brief Calls f(neighbour) for every neighbour of id. This is the way kernels should walk the adjacency,
+         * as it works on the plain as well as on the compressed targets.
+         */
+        template<typename F> void for_each_neighbor(node_int id, F f){
+            if(compressed){
+                for_each_neighbor_as<true>(id, f);
+                return;
+            }
+            for_each_neighbor_as<false>(id, f);
+        }
+        /**
+         * @brief Same as for_each_neighbor, with the representation fixed at compile time. Meant for kernels
+         * instantiated per representation (see dispatch_graph), COMPRESSED has to match is_compressed().
+         */
+        template<bool COMPRESSED, typename F> void for_each_neighbor_as(node_int id, F f){
+            if constexpr(COMPRESSED){
+                adjacency.for_each(id, f);
+            }
+            else{
+                for(edge_int i = offsets[id]; i < offsets[id + 1]; i++){
+                    f(targets[i]);
+                }
+            }
+        }
+
+        /**
+         * @brief Replaces the targets by their compressed form (see CompressedAdjacency) and frees them along with
+         * the offsets.
+         */
+        void compress();
+        bool is_compressed();
+        CompressedAdjacency& get_compressed_adjacency();
+        /**
+         * @brief Uses an already compressed adjacency (e.g. read from a '-graph.bin') instead of the targets.
+         */
+        void set_compressed_adjacency(CompressedAdjacency adjacency);
+
+        /**
+         * @brief Relabels every vertex v as perm[v], rebuilding the CSR (with sorted neighbour lists) and the
+         * communities. Successive calls compose, so the original ids are always recoverable.
+         */
+        void relabel(const std::vector<node_int>& perm);
+        /**
+         * @brief Maps an internal (possibly relabelled) id back to the id used in the input file.
+         */
+        node_int get_original_id(node_int id);
+        /**
+         * @brief Maps an id from the input file to the internal id.
+         */
+        node_int get_internal_id(node_int original_id);
+        bool is_relabelled();
+        std::vector<node_int>& get_original_ids();
+        /**
+         * @brief Restores a relabelling (internal -> original ids), e.g. read from a '-order.bin'.
+         */
+        void set_original_ids(std::vector<node_int> original_ids);
 
     private:
-        graph_type graph_type;
-        node_int edge_nr;
+        /**
+         * @brief Updates the accounted size (MEMORY_GRAPH) to the current size of the vectors.
+         */
+        void track_memory();
+        /**
+         * @brief Frees the offsets and targets, once the compressed adjacency replaces them.
+         */
+        void free_csr();
+
+        graph_type type;
+        edge_int edge_nr;
         node_int vertex_nr;
-        std::vector<node_int> offsets;
+        std::vector<edge_int> offsets;
         std::vector<node_int> targets;
-        std::vector<node_int> degrees;
         std::vector<node_int> communities;
+        // If set, offsets and targets are empty and the neighbours live in adjacency.
+        bool compressed = false;
+        CompressedAdjacency adjacency;
+        // Empty unless the graph was relabelled. permutation: original -> internal, original_ids: internal -> original.
+        std::vector<node_int> permutation;
+        std::vector<node_int> original_ids;
+        int64_t tracked_bytes = 0;
 };
 
 #endif
\ No newline at end of file
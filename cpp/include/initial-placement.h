@@ -0,0 +1,37 @@
+#ifndef INITIAL_PLACEMENT_H
+#define INITIAL_PLACEMENT_H
+
+#include <vector>
+#include <random>
+#include "graph.h"
+
+enum initial_placement{
+    /**
+     * @brief Uniformly random positions on the canvas.
+     */
+    RANDOM_PLACEMENT,
+    /**
+     * @brief Pivot MDS (see: Brandes and Pich, "Eigensolver Methods for Progressive Multidimensional Scaling of Large
+     * Data"): BFS distances from fdl::PIVOT_NR pivots, projected onto their two main axes.
+     */
+    PIVOT_MDS,
+    /**
+     * @brief Every community gets a disc on a spiral, its nodes are scattered inside it. Needs the communities
+     * (label_prop) to be computed first.
+     */
+    COMMUNITY_PLACEMENT
+};
+
+/**
+ * @brief The BFS distance (in hops) of every vertex from source, unreachable vertices get max_distance + 1.
+ */
+std::vector<uint32_t> bfs_distances(Graph* graph, node_int source);
+/**
+ * @brief Computes the start positions of the layout, centred on (0,0).
+ *
+ * @param       k           The ideal edge length of the layout, the placements are scaled to it
+ */
+std::vector<std::pair<double,double>> place_nodes(Graph* graph, initial_placement placement, double width, double height,
+                                                  double k, std::mt19937& rng);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef IO_WRITER_H
+#define IO_WRITER_H
+
+#include <string>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+/**
+ * @brief A single background thread doing all file writes in submission order, so the computing threads
+ * never wait for the disk.
+ */
+class IOWriter{
+    public:
+        IOWriter();
+        ~IOWriter();
+
+        /**
+         * @brief Queues a job doing its own file I/O (e.g. graph_to_bin). Anything it reads must stay unchanged
+         * until it ran, which the returned future tells.
+         */
+        std::future<void> submit(std::function<void()> job);
+        /**
+         * @brief Queues writing data to path. The data is moved into the writer, so the caller may go on right away.
+         */
+        std::future<void> write(std::string path, std::string data);
+        /**
+         * @brief Blocks until every queued job has finished.
+         */
+        void wait();
+
+    private:
+        void work();
+
+        std::thread worker;
+        std::queue<std::function<void()>> jobs;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        bool busy = false;
+        bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef KERNEL_DISPATCH_H
+#define KERNEL_DISPATCH_H
+
+#include <type_traits>
+#include "graph.h"
+
+/**
+ * @brief Turns the runtime properties of a graph into compile time constants, so that kernels can be templated on
+ * them and their inner loops don't test them per edge.
+ *
+ * Calls kernel(type, compressed) with type a std::integral_constant<graph_type, ...> and compressed a std::bool_constant,
+ * both usable as template arguments through decltype(...)::value. The index width is not dispatched on, node_int is
+ * fixed at compile time.
+ */
+template<typename K> void dispatch_graph(Graph* graph, K kernel){
+    using undirected = std::integral_constant<graph_type, UNDIRECTED>;
+    using directed = std::integral_constant<graph_type, DIRECTED>;
+
+    if(graph->get_graph_type() == UNDIRECTED){
+        if(graph->is_compressed()){
+            kernel(undirected(), std::true_type());
+        }
+        else{
+            kernel(undirected(), std::false_type());
+        }
+    }
+    else{
+        if(graph->is_compressed()){
+            kernel(directed(), std::true_type());
+        }
+        else{
+            kernel(directed(), std::false_type());
+        }
+    }
+}
+
+/**
+ * @brief Same for a single feature flag (e.g. a setting of config.h): calls kernel(std::bool_constant<flag>).
+ */
+template<typename K> void dispatch_flag(bool flag, K kernel){
+    if(flag){
+        kernel(std::true_type());
+    }
+    else{
+        kernel(std::false_type());
+    }
+}
+
+#endif
@@ -2,7 +2,12 @@
 #define LABELPROP_H
 
 #include "graph.h"
+#include <random>
 
-int label_prop(Graph* graph);
+/**
+ * @brief One iteration of the label propagation. Ties are broken with rng, which the caller owns, so that concurrent
+ * runs (e.g. batch jobs) neither share nor reseed a generator.
+ */
+int label_prop(Graph* graph, std::mt19937& rng);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef LAYOUT_QUALITY_H
+#define LAYOUT_QUALITY_H
+
+#include <string>
+#include <vector>
+#include "graph.h"
+
+/**
+ * @brief Quality metrics of a layout. All of them are sampled and independent of the scale of the layout, so
+ * layouts of different settings (canvas, placement, packing) can be compared directly.
+ */
+struct layout_quality{
+    /**
+     * @brief Normalised stress, the mean of ((s*distance - hops) / hops)^2 over all pairs from fdl::EVALUATE_SOURCES
+     * BFS sources to the rest of their component, with s the scale that minimises it. Lower is better.
+     */
+    double stress;
+    /**
+     * @brief The standard deviation of the edge lengths over their mean. Lower is more uniform.
+     */
+    double edge_length_cv;
+    /**
+     * @brief The mean Jaccard similarity between the neighbours of a vertex and its deg(v) nearest vertices in the
+     * layout, over fdl::EVALUATE_SAMPLES vertices. Higher is better, 1 is perfect.
+     */
+    double neighbourhood_preservation;
+    /**
+     * @brief The mean number of edges crossed by an edge, over fdl::EVALUATE_SAMPLES edges. Lower is better.
+     */
+    double crossings_per_edge;
+};
+
+/**
+ * @brief Measures a layout of graph.
+ *
+ * @param       pos         The positions, indexed by the ids of graph (e.g. FDL::pos)
+ * @param       seed        The seed of the samples, the same seed measures every layout of a graph on the same samples
+ */
+layout_quality measure_layout(Graph* graph, const std::vector<std::pair<double,double>>& pos, unsigned seed);
+
+/**
+ * @brief Lays out the edge list with every combination of initial_placement, fdl::LAYOUT_BY_COMPONENT and
+ * half/default/double the iterations, fdl::EVALUATE_SEEDS times each, and prints the mean time and quality of
+ * every combination. Nothing is written.
+ */
+int evaluate_layouts(std::string file_name);
+
+#endif
@@ -3,6 +3,9 @@
 
 #include <string>
 
+// Whether print_progress_bar draws anything, off while several jobs run at once.
+extern bool SHOW_PROGRESS;
+
 void DEBUG_PRINT(std::string str);
 void print_progress_bar(double m);
 
@@ -0,0 +1,93 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <string>
+#include <cstdint>
+
+enum memory_subsystem{
+    /**
+     * @brief The edge buffer of txt_to_graph.
+     */
+    MEMORY_PARSE,
+    /**
+     * @brief The CSR (plain or compressed) and the labels of every Graph, component subgraphs included.
+     */
+    MEMORY_GRAPH,
+    /**
+     * @brief The positions and displacements of every FDL.
+     */
+    MEMORY_LAYOUT,
+    /**
+     * @brief The oriented CSR and the per thread counts of count_triangles.
+     */
+    MEMORY_TRIANGLES,
+    /**
+     * @brief Data handed to the IOWriter (e.g. the JSON snapshots), until it is written.
+     */
+    MEMORY_QUEUED_WRITES,
+    MEMORY_SUBSYSTEM_NR
+};
+
+/**
+ * @brief Accounts an allocation (bytes > 0) or a release (bytes < 0) of a subsystem. Thread safe.
+ */
+void memory_track(memory_subsystem subsystem, int64_t bytes);
+/**
+ * @brief The bytes currently accounted, over all subsystems.
+ */
+uint64_t memory_current();
+/**
+ * @brief Prints the peak of every subsystem, of their sum and of the resident set (where the OS tells).
+ */
+void memory_report();
+
+/**
+ * @brief The strategies a run uses to stay under config::MEMORY_BUDGET (see plan_memory). Without a budget all
+ * of them are off, except what the config asks for anyway.
+ */
+struct memory_plan{
+    /**
+     * @brief Reads the edge list twice (degrees first, then the targets) instead of buffering every edge.
+     */
+    bool two_pass_parse = false;
+    /**
+     * @brief Compresses the adjacency right after loading (see config::COMPRESS_ADJACENCY).
+     */
+    bool compress = false;
+    /**
+     * @brief Lays out every component on its own (see fdl::LAYOUT_BY_COMPONENT), which copies them.
+     */
+    bool by_component = true;
+    /**
+     * @brief Writes the JSON snapshots straight into their files on the I/O thread instead of building them in memory.
+     */
+    bool stream_json = false;
+    /**
+     * @brief The memory the external build may use for its runs, at most config::EXTERNAL_MEMORY_BUDGET.
+     */
+    uint64_t external_budget = 0;
+    /**
+     * @brief The estimated peak of the run with the strategies above.
+     */
+    uint64_t estimate = 0;
+    /**
+     * @brief The part of the budget held for the run until memory_release, the estimate if there is a budget.
+     */
+    uint64_t reserved = 0;
+};
+
+/**
+ * @brief Picks the strategies for processing the edge list. The footprint is estimated from its line count, and
+ * strategies are switched on, cheapest first, until the estimate fits into config::MEMORY_BUDGET minus what the
+ * runs still going (e.g. the other jobs of a batch) reserved, or minus what is accounted if that's more. The
+ * estimate is then reserved as well, so jobs planned at the same time don't count on the same memory.
+ *
+ * @param       external    Whether the graph is built out of core (then the edge list isn't parsed in memory)
+ */
+memory_plan plan_memory(std::string file_name, bool external);
+/**
+ * @brief Gives the reservation of a plan back to the budget, once its run is done.
+ */
+void memory_release(const memory_plan& plan);
+
+#endif
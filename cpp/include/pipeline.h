@@ -0,0 +1,21 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <string>
+#include "graph.h"
+#include "thread-pool.h"
+#include "io-writer.h"
+
+/**
+ * @brief What a single run of the pipeline processed, and how long it took.
+ */
+struct pipeline_stats{
+    node_int vertex_nr = 0;
+    edge_int edge_nr = 0;
+    double seconds = 0.0;
+};
+
+int process_pipeline(std::string file_name, bool external = false, ThreadPool* shared_pool = nullptr, IOWriter* shared_io = nullptr,
+                     pipeline_stats* stats = nullptr);
+
+#endif
@@ -6,6 +6,21 @@
 #include <string>
 #include <iostream>
 
+/**
+ * @brief Reads the edge on a line of an edge list, the same way for every build of the graph. Blank and malformed
+ * lines are skipped, as are (with an error) lines with an id beyond node_int.
+ *
+ * @return      1 if the line holds an edge, 0 if it's skipped
+ */
+int parse_edge(const std::string& line, node_int& idA, node_int& idB);
+Graph* txt_to_graph(std::string dir, bool two_pass = false);
+int prepare_graph(Graph* graph);
+int find_communities(Graph* graph);
+int finish_graph(Graph* graph);
+int graph_to_bin(std::string file_name, Graph* graph);
+Graph* bin_to_graph(std::string file_name, bool compress = false);
+int communities_to_bin(std::string file_name, Graph* graph, int iteration);
+int order_to_bin(std::string file_name, Graph* graph);
 Graph* preproc(std::string dir, bool communities);
 
 #endif
\ No newline at end of file
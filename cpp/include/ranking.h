@@ -5,6 +5,7 @@
 #include <iostream>
 #include "config.h"
 #include "graph.h"
+#include "triangles.h"
 
 enum ranking_algorithm{
     /**
@@ -18,9 +19,17 @@ enum ranking_algorithm{
     /**
      * @brief Gives each node a rank based on how many neighbours that node has (e.g. it's neighbourhood).
      */
-    NEIGHBOURHOOD
+    NEIGHBOURHOOD,
+    /**
+     * @brief Gives each node its local clustering coefficient in permille (0 - 1000), see count_triangles.
+     */
+    CLUSTERING_COEFFICIENT
 };
 
 std::vector<node_int> rank_graph(Graph* graph, ranking_algorithm algorithm);
+/**
+ * @brief The CLUSTERING_COEFFICIENT ranks from already counted triangles, so they aren't counted twice.
+ */
+std::vector<node_int> rank_clustering(const triangle_counts& counts);
 
 #endif
\ No newline at end of file
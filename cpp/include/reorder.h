@@ -0,0 +1,31 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+#include <vector>
+#include "config.h"
+#include "graph.h"
+
+enum reorder_algorithm{
+    /**
+     * @brief Keeps the ids from the input file.
+     */
+    NO_REORDER,
+    /**
+     * @brief Sorts the vertices by descending degree, so the hubs (and their frequently touched data) are packed together.
+     */
+    DEGREE_SORT,
+    /**
+     * @brief Reverse Cuthill-McKee. Reduces the bandwidth of the adjacency matrix, so neighbours get nearby ids.
+     */
+    REVERSE_CUTHILL_MCKEE,
+    /**
+     * @brief Places every community from the label propagation contiguously (hubs first inside a community).
+     * Has to run after label_prop.
+     */
+    COMMUNITY_CONTIGUOUS
+};
+
+std::vector<node_int> reorder_permutation(Graph* graph, reorder_algorithm algorithm);
+int reorder_graph(Graph* graph, reorder_algorithm algorithm);
+
+#endif
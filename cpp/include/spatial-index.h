@@ -0,0 +1,46 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <string>
+#include <vector>
+#include "graph.h"
+
+/**
+ * @brief Read-only k-d tree over the final layout positions, used for picking and viewport culling.
+ *
+ * The tree is implicit: for every range [begin, end) the splitting point sits at (begin + end) / 2, splitting
+ * along x on even depths and along y on odd depths. The whole tree is therefore just the two flat arrays below,
+ * which is also exactly how it is stored on disk (see spatial_index_to_bin).
+ */
+class SpatialIndex{
+    public:
+        SpatialIndex(std::vector<std::pair<double,double>> points, std::vector<node_int> ids)
+            : points(points), ids(ids){}
+
+        /**
+         * @brief Returns the ids of all nodes inside the rectangle [min_x, max_x] x [min_y, max_y].
+         */
+        std::vector<node_int> query_box(double min_x, double min_y, double max_x, double max_y);
+        /**
+         * @brief Returns the ids of all nodes within distance r of (x, y).
+         */
+        std::vector<node_int> query_radius(double x, double y, double r);
+        /**
+         * @brief Returns the ids of the k nodes nearest to (x, y), closest first.
+         */
+        std::vector<node_int> query_nearest(double x, double y, size_t k);
+
+        size_t size();
+        std::vector<std::pair<double,double>>& get_points();
+        std::vector<node_int>& get_ids();
+
+    private:
+        std::vector<std::pair<double,double>> points;
+        std::vector<node_int> ids;
+};
+
+SpatialIndex* spatial_index_build(const std::vector<std::pair<double,double>>& pos, Graph* graph);
+int spatial_index_to_bin(std::string file_name, SpatialIndex* index);
+SpatialIndex* spatial_index_from_bin(std::string file_name);
+
+#endif
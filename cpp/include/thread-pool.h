@@ -0,0 +1,103 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <chrono>
+
+/**
+ * @brief Fixed size, work-stealing pool of worker threads.
+ *
+ * Every worker has its own deque: tasks submitted from a worker go to the back of its deque and are run from
+ * there (newest first, while their data is still in cache), idle workers steal from the front of the others
+ * (oldest first, usually the largest pieces of work). Tasks submitted from outside go to a shared deque.
+ *
+ * Tasks may wait for other tasks of the same pool, as long as they do so through wait(), which keeps running
+ * queued tasks instead of blocking. That is what lets nested work (e.g. a layout splitting into components inside
+ * a batch job) share one pool. A waiting worker only runs tasks of its own deque, i.e. the subtasks it submitted:
+ * anything else (e.g. another batch job) could keep it from resuming long after the task it waits for is done.
+ */
+class ThreadPool{
+    public:
+        /**
+         * @param       thread_nr   The number of workers, 0 picks one per hardware thread
+         */
+        ThreadPool(unsigned thread_nr);
+        ~ThreadPool();
+
+        template<typename F> auto submit(F f) -> std::future<decltype(f())> {
+            auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::move(f));
+            std::future<decltype(f())> result = task->get_future();
+            push([task](){ (*task)(); });
+
+            return result;
+        }
+
+        /**
+         * @brief Returns the result of f, running queued tasks of this pool until it's ready. On a worker, only the
+         * tasks of its own deque.
+         */
+        template<typename T> T wait(std::future<T>& f){
+            while(f.wait_for(std::chrono::seconds(0)) != std::future_status::ready){
+                if(!run_one(true)){
+                    // nothing to help with, so the task we wait for is running somewhere else
+                    f.wait_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            return f.get();
+        }
+
+        unsigned get_thread_nr();
+
+        /**
+         * @brief The pool the calling thread is a worker of, nullptr outside of any pool.
+         */
+        static ThreadPool* current();
+
+    private:
+        struct task_queue{
+            std::deque<std::function<void()>> tasks;
+            std::mutex mutex;
+        };
+
+        void push(std::function<void()> task);
+        /**
+         * @brief Runs one queued task: the newest one of the own deque, else the oldest one of the shared deque
+         * or of another worker. Returns false if there was none.
+         *
+         * @param       waiting     Called from wait(), a worker then doesn't steal
+         */
+        bool run_one(bool waiting = false);
+        void work(unsigned index);
+
+        std::vector<std::thread> workers;
+        // One deque per worker, the last one is the shared one for tasks submitted from outside.
+        std::vector<std::unique_ptr<task_queue>> queues;
+        std::atomic<size_t> pending{0};
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+};
+
+/**
+ * @brief The pool of the calling worker, so that nested work shares it, or outside of any pool a new one with
+ * thread_nr workers, owned by own.
+ */
+inline ThreadPool* current_or_own_pool(std::unique_ptr<ThreadPool>& own, unsigned thread_nr){
+    if(ThreadPool::current()){
+        return ThreadPool::current();
+    }
+
+    own.reset(new ThreadPool(thread_nr));
+    return own.get();
+}
+
+#endif
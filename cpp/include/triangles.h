@@ -0,0 +1,37 @@
+#ifndef TRIANGLES_H
+#define TRIANGLES_H
+
+#include <string>
+#include <vector>
+#include "graph.h"
+
+/**
+ * @brief The triangles of a graph (directions and duplicate edges ignored, as in the undirected graph underneath).
+ */
+struct triangle_counts{
+    uint64_t total = 0;
+    // Triangles through every vertex.
+    std::vector<uint64_t> per_vertex;
+    // Local clustering coefficient: triangles through v / pairs of neighbours of v, 0 below degree 2.
+    std::vector<double> clustering;
+    // 3 * total / number of paths of length 2 (transitivity).
+    double global_clustering = 0.0;
+    // Mean of clustering over all vertices.
+    double average_clustering = 0.0;
+};
+
+/**
+ * @brief Counts the triangles with the forward algorithm: every edge points from the lower to the higher (degree, id)
+ * vertex, so every triangle is found exactly once, at its lowest vertex, by intersecting two sorted out-lists.
+ * The intersections use SSE4.2 string compares where the CPU has them, or a bitmap for long lists.
+ *
+ * @param       thread_nr   The number of threads, 0 uses one per hardware thread. Called from a pool worker, the
+ *                          pool is shared instead
+ */
+triangle_counts count_triangles(Graph* graph, unsigned thread_nr);
+/**
+ * @brief Writes the triangle counts and clustering coefficients to '-clustering.bin', in the order of the input file.
+ */
+int clustering_to_bin(std::string file_name, Graph* graph, const triangle_counts& counts);
+
+#endif
@@ -0,0 +1,551 @@
+/**
+ * @brief Python extension module 'graph_explorer', giving Python direct access to the C++ engines instead of going
+ * through the JSON files on disk.
+ *
+ * All arrays handed to Python alias the C++ buffers, nothing is copied: the arrays of a graph keep that graph alive,
+ * ranks and positions own their buffers through a capsule. The GIL is released while the engines run, so other
+ * Python threads keep going.
+ *
+ * Reordering a graph (config::REORDER_ALGORITHM) replaces its buffers, so arrays taken from it before that are stale.
+ * The functions below only reorder inside load and preproc, before any array can have been taken.
+ *
+ * Built with scripts/compile-python.bat, only needs the Python and NumPy headers.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+#include <type_traits>
+#include "graph.h"
+#include "preproc.h"
+#include "ranking.h"
+#include "triangles.h"
+#include "force-directed-layout.h"
+#include "layout-quality.h"
+#include "config.h"
+#include "config-loader.h"
+
+// main.cpp is not part of the module, so it brings its own (quiet) versions of these.
+bool DEBUG_MODE = false;
+bool SHOW_PROGRESS = false;
+
+void DEBUG_PRINT(std::string str){
+    if(DEBUG_MODE){
+        std::cout << "[DEBUG] " << str << std::endl;
+    }
+}
+
+void print_progress_bar(double progress){
+}
+
+static_assert(sizeof(node_int) == 2, "the arrays below are typed as NPY_UINT16");
+static_assert(sizeof(edge_int) == 8, "the arrays below are typed as NPY_UINT64");
+static_assert(sizeof(std::pair<double,double>) == 2 * sizeof(double), "FDL::pos is handed out as an (n, 2) array");
+
+/**
+ * @brief The Python object wrapping a Graph.
+ */
+struct PyGraph{
+    PyObject_HEAD
+    Graph* graph;
+};
+
+static PyObject* graph_type = nullptr;
+
+/**
+ * @brief Wraps a buffer into a 1D array, whose base (the owner of the buffer) is given in base. Steals base.
+ */
+static PyObject* alias_array(void* data, npy_intp size, int type_num, PyObject* base){
+    PyObject* array = PyArray_SimpleNewFromData(1, &size, type_num, data);
+    if(!array){
+        Py_DECREF(base);
+        return nullptr;
+    }
+
+    // read-only, as writing into e.g. the offsets would break the graph
+    PyArray_CLEARFLAGS((PyArrayObject*)array, NPY_ARRAY_WRITEABLE);
+    if(PyArray_SetBaseObject((PyArrayObject*)array, base) < 0){
+        Py_DECREF(array);
+        return nullptr;
+    }
+
+    return array;
+}
+
+template<typename T> static int npy_type(){
+    if(std::is_same<T, double>::value){
+        return NPY_FLOAT64;
+    }
+    return std::is_same<T, uint64_t>::value ? NPY_UINT64 : NPY_UINT16;
+}
+
+/**
+ * @brief Returns an array aliasing one of the vectors of a graph, keeping the graph alive for as long as the array.
+ */
+template<typename T> static PyObject* graph_array(PyGraph* self, std::vector<T>& buffer){
+    Py_INCREF(self);
+    return alias_array(buffer.data(), buffer.size(), npy_type<T>(), (PyObject*)self);
+}
+
+/**
+ * @brief Hands a vector over to Python without copying it: it's moved onto the heap and freed with the capsule.
+ */
+template<typename T> static void free_vector(PyObject* capsule){
+    delete (std::vector<T>*)PyCapsule_GetPointer(capsule, "graph_explorer.vector");
+}
+
+template<typename T> static PyObject* vector_array(std::vector<T>&& buffer){
+    std::vector<T>* owned = new std::vector<T>(std::move(buffer));
+    PyObject* capsule = PyCapsule_New(owned, "graph_explorer.vector", free_vector<T>);
+    if(!capsule){
+        delete owned;
+        return nullptr;
+    }
+
+    return alias_array(owned->data(), owned->size(), npy_type<T>(), capsule);
+}
+
+static void free_fdl(PyObject* capsule){
+    delete (FDL*)PyCapsule_GetPointer(capsule, "graph_explorer.fdl");
+}
+
+static PyObject* wrap_graph(Graph* graph){
+    if(!graph){
+        PyErr_SetString(PyExc_IOError, "could not read the graph");
+        return nullptr;
+    }
+
+    PyGraph* self = PyObject_New(PyGraph, (PyTypeObject*)graph_type);
+    if(!self){
+        delete graph;
+        return nullptr;
+    }
+    self->graph = graph;
+
+    return (PyObject*)self;
+}
+
+static Graph* unwrap_graph(PyObject* object){
+    if(!PyObject_TypeCheck(object, (PyTypeObject*)graph_type)){
+        PyErr_SetString(PyExc_TypeError, "expected a graph_explorer.Graph");
+        return nullptr;
+    }
+
+    return ((PyGraph*)object)->graph;
+}
+
+static void graph_dealloc(PyObject* self){
+    PyTypeObject* type = Py_TYPE(self);
+    delete ((PyGraph*)self)->graph;
+    PyObject_Free(self);
+    Py_DECREF(type);
+}
+
+static PyObject* graph_offsets(PyObject* self, PyObject*){
+    PyGraph* py_graph = (PyGraph*)self;
+    if(py_graph->graph->is_compressed()){
+        // a compressed graph has no offsets to alias, they're summed up from the degrees
+        std::vector<edge_int> offsets(py_graph->graph->get_vertex_nr() + 1, 0);
+        for(node_int v = 0; v < py_graph->graph->get_vertex_nr(); v++){
+            offsets[v + 1] = offsets[v] + py_graph->graph->get_degree(v);
+        }
+        return vector_array(std::move(offsets));
+    }
+
+    return graph_array(py_graph, py_graph->graph->get_offsets());
+}
+
+static PyObject* graph_targets(PyObject* self, PyObject*){
+    PyGraph* py_graph = (PyGraph*)self;
+    if(py_graph->graph->is_compressed()){
+        PyErr_SetString(PyExc_ValueError, "the targets are compressed (config::COMPRESS_ADJACENCY), use neighbors() instead");
+        return nullptr;
+    }
+
+    return graph_array(py_graph, py_graph->graph->get_targets());
+}
+
+static PyObject* graph_degrees(PyObject* self, PyObject*){
+    PyGraph* py_graph = (PyGraph*)self;
+    return vector_array(py_graph->graph->get_degrees());
+}
+
+static PyObject* graph_communities(PyObject* self, PyObject*){
+    PyGraph* py_graph = (PyGraph*)self;
+    return graph_array(py_graph, py_graph->graph->get_communities());
+}
+
+static PyObject* graph_original_ids(PyObject* self, PyObject*){
+    PyGraph* py_graph = (PyGraph*)self;
+    if(!py_graph->graph->is_relabelled()){
+        Py_RETURN_NONE;
+    }
+
+    return graph_array(py_graph, py_graph->graph->get_original_ids());
+}
+
+/**
+ * @brief The neighbours of a single vertex. This one is a copy, as compressed lists have no buffer to alias.
+ */
+static PyObject* graph_neighbors(PyObject* self, PyObject* args){
+    Graph* graph = ((PyGraph*)self)->graph;
+
+    unsigned long id;
+    if(!PyArg_ParseTuple(args, "k", &id)){
+        return nullptr;
+    }
+    if(id >= graph->get_vertex_nr()){
+        PyErr_SetString(PyExc_IndexError, "vertex id out of range");
+        return nullptr;
+    }
+
+    std::vector<node_int> neighbors;
+    neighbors.reserve(graph->get_degree(id));
+    graph->for_each_neighbor(id, [&neighbors](node_int u){
+        neighbors.push_back(u);
+    });
+
+    return vector_array(std::move(neighbors));
+}
+
+static PyObject* graph_vertex_nr(PyObject* self, void*){
+    return PyLong_FromUnsignedLong(((PyGraph*)self)->graph->get_vertex_nr());
+}
+
+static PyObject* graph_edge_nr(PyObject* self, void*){
+    return PyLong_FromUnsignedLongLong(((PyGraph*)self)->graph->get_edge_nr());
+}
+
+static PyMethodDef graph_methods[] = {
+    {"offsets", graph_offsets, METH_NOARGS, "The CSR offsets (uint64, vertex_nr + 1 entries), a copy for compressed graphs."},
+    {"targets", graph_targets, METH_NOARGS, "The CSR targets (uint16), not available for compressed graphs."},
+    {"degrees", graph_degrees, METH_NOARGS, "The degree of every vertex (uint64), a copy."},
+    {"communities", graph_communities, METH_NOARGS, "The community label of every vertex (uint16)."},
+    {"original_ids", graph_original_ids, METH_NOARGS, "The id in the input file of every vertex, None if the graph wasn't reordered."},
+    {"neighbors", graph_neighbors, METH_VARARGS, "neighbors(id) -> the neighbours of a vertex (uint16)."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyGetSetDef graph_getset[] = {
+    {"vertex_nr", graph_vertex_nr, nullptr, "The number of vertices.", nullptr},
+    {"edge_nr", graph_edge_nr, nullptr, "The number of (stored) edges.", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+static PyType_Slot graph_slots[] = {
+    {Py_tp_dealloc, (void*)graph_dealloc},
+    {Py_tp_methods, graph_methods},
+    {Py_tp_getset, graph_getset},
+    {Py_tp_doc, (void*)"A CSR graph owned by the C++ side, see the load functions of the module."},
+    {0, nullptr}
+};
+
+static PyType_Spec graph_spec = {
+    "graph_explorer.Graph",
+    sizeof(PyGraph),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    graph_slots
+};
+
+/**
+ * @brief load(path) -> Graph, reads a '.txt' edge list and prepares it like the process command does (reordering,
+ * compression), without finding communities or writing anything.
+ */
+static PyObject* py_load(PyObject*, PyObject* args){
+    const char* path;
+    if(!PyArg_ParseTuple(args, "s", &path)){
+        return nullptr;
+    }
+
+    Graph* graph;
+    Py_BEGIN_ALLOW_THREADS
+    graph = txt_to_graph(path);
+    if(graph){
+        prepare_graph(graph);
+    }
+    Py_END_ALLOW_THREADS
+
+    return wrap_graph(graph);
+}
+
+/**
+ * @brief load_bin(path) -> Graph, reads the '-graph.bin' of an earlier run, path being that of the '.txt'.
+ */
+static PyObject* py_load_bin(PyObject*, PyObject* args){
+    const char* path;
+    if(!PyArg_ParseTuple(args, "s", &path)){
+        return nullptr;
+    }
+
+    Graph* graph;
+    Py_BEGIN_ALLOW_THREADS
+    graph = bin_to_graph(path);
+    Py_END_ALLOW_THREADS
+
+    return wrap_graph(graph);
+}
+
+/**
+ * @brief preproc(path, communities=True) -> Graph, the whole preprocessing including the binary outputs.
+ */
+static PyObject* py_preproc(PyObject*, PyObject* args){
+    const char* path;
+    int communities = 1;
+    if(!PyArg_ParseTuple(args, "s|p", &path, &communities)){
+        return nullptr;
+    }
+
+    Graph* graph;
+    Py_BEGIN_ALLOW_THREADS
+    graph = preproc(path, communities);
+    Py_END_ALLOW_THREADS
+
+    return wrap_graph(graph);
+}
+
+/**
+ * @brief label_propagation(graph) -> communities, runs find_communities and returns graph.communities().
+ */
+static PyObject* py_label_propagation(PyObject*, PyObject* args){
+    PyObject* object;
+    if(!PyArg_ParseTuple(args, "O", &object)){
+        return nullptr;
+    }
+    Graph* graph = unwrap_graph(object);
+    if(!graph){
+        return nullptr;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    find_communities(graph);
+    Py_END_ALLOW_THREADS
+
+    return graph_array((PyGraph*)object, graph->get_communities());
+}
+
+/**
+ * @brief rank(graph, algorithm=config::RANKING_ALGORITHM) -> ranks, see ranking_algorithm for the values.
+ */
+static PyObject* py_rank(PyObject*, PyObject* args){
+    PyObject* object;
+    int algorithm = config::RANKING_ALGORITHM;
+    if(!PyArg_ParseTuple(args, "O|i", &object, &algorithm)){
+        return nullptr;
+    }
+    Graph* graph = unwrap_graph(object);
+    if(!graph){
+        return nullptr;
+    }
+    // the PageRank values aren't implemented, as in the config (see config_set)
+    if(algorithm < NEIGHBOURHOOD || algorithm > CLUSTERING_COEFFICIENT){
+        PyErr_SetString(PyExc_ValueError, "unsupported ranking algorithm, expected NEIGHBOURHOOD or CLUSTERING_COEFFICIENT");
+        return nullptr;
+    }
+
+    std::vector<node_int> ranking;
+    Py_BEGIN_ALLOW_THREADS
+    ranking = rank_graph(graph, (ranking_algorithm)algorithm);
+    Py_END_ALLOW_THREADS
+
+    return vector_array(std::move(ranking));
+}
+
+/**
+ * @brief triangles(graph) -> (total, per vertex triangles, clustering coefficients, global clustering), see
+ * count_triangles.
+ */
+static PyObject* py_triangles(PyObject*, PyObject* args){
+    PyObject* object;
+    if(!PyArg_ParseTuple(args, "O", &object)){
+        return nullptr;
+    }
+    Graph* graph = unwrap_graph(object);
+    if(!graph){
+        return nullptr;
+    }
+
+    triangle_counts counts;
+    Py_BEGIN_ALLOW_THREADS
+    counts = count_triangles(graph, config::PIPELINE_THREADS);
+    Py_END_ALLOW_THREADS
+
+    PyObject* per_vertex = vector_array(std::move(counts.per_vertex));
+    if(!per_vertex){
+        return nullptr;
+    }
+    PyObject* clustering = vector_array(std::move(counts.clustering));
+    if(!clustering){
+        Py_DECREF(per_vertex);
+        return nullptr;
+    }
+
+    return Py_BuildValue("(KNNd)", (unsigned long long)counts.total, per_vertex, clustering, counts.global_clustering);
+}
+
+/**
+ * @brief layout(graph) -> positions, runs the force directed layout and returns FDL::pos as a (vertex_nr, 2) float64
+ * array.
+ *
+ * Unlike the arrays aliasing a graph, the positions are writeable: the FDL belongs to the array alone and is never
+ * read again, so e.g. moving vertices by hand before layout_quality can't break anything.
+ */
+static PyObject* py_layout(PyObject*, PyObject* args){
+    PyObject* object;
+    if(!PyArg_ParseTuple(args, "O", &object)){
+        return nullptr;
+    }
+    Graph* graph = unwrap_graph(object);
+    if(!graph){
+        return nullptr;
+    }
+
+    FDL* fdl;
+    Py_BEGIN_ALLOW_THREADS
+    fdl = fdl_start(graph);
+    fdl_layout(fdl, graph);
+    Py_END_ALLOW_THREADS
+
+    PyObject* capsule = PyCapsule_New(fdl, "graph_explorer.fdl", free_fdl);
+    if(!capsule){
+        delete fdl;
+        return nullptr;
+    }
+
+    npy_intp dims[2] = {(npy_intp)fdl->pos.size(), 2};
+    npy_intp strides[2] = {sizeof(std::pair<double,double>), sizeof(double)};
+    PyObject* array = PyArray_New(&PyArray_Type, 2, dims, NPY_FLOAT64, strides, fdl->pos.data(), 0, NPY_ARRAY_WRITEABLE, nullptr);
+    if(!array){
+        Py_DECREF(capsule);
+        return nullptr;
+    }
+    if(PyArray_SetBaseObject((PyArrayObject*)array, capsule) < 0){
+        Py_DECREF(array);
+        return nullptr;
+    }
+
+    return array;
+}
+
+/**
+ * @brief layout_quality(graph, positions) -> dict, the metrics of measure_layout for any (vertex_nr, 2) positions,
+ * e.g. those returned by layout().
+ */
+static PyObject* py_layout_quality(PyObject*, PyObject* args){
+    PyObject* object;
+    PyObject* positions;
+    if(!PyArg_ParseTuple(args, "OO", &object, &positions)){
+        return nullptr;
+    }
+    Graph* graph = unwrap_graph(object);
+    if(!graph){
+        return nullptr;
+    }
+
+    PyArrayObject* array = (PyArrayObject*)PyArray_FROMANY(positions, NPY_FLOAT64, 2, 2, NPY_ARRAY_IN_ARRAY);
+    if(!array){
+        return nullptr;
+    }
+    if(PyArray_DIM(array, 0) != graph->get_vertex_nr() || PyArray_DIM(array, 1) != 2){
+        Py_DECREF(array);
+        PyErr_SetString(PyExc_ValueError, "positions must have the shape (vertex_nr, 2)");
+        return nullptr;
+    }
+
+    const double* data = (const double*)PyArray_DATA(array);
+    std::vector<std::pair<double,double>> pos(graph->get_vertex_nr());
+    for(size_t v = 0; v < pos.size(); v++){
+        pos[v] = {data[2*v], data[2*v + 1]};
+    }
+    Py_DECREF(array);
+
+    layout_quality quality;
+    Py_BEGIN_ALLOW_THREADS
+    quality = measure_layout(graph, pos, config_seed());
+    Py_END_ALLOW_THREADS
+
+    return Py_BuildValue("{s:d,s:d,s:d,s:d}", "stress", quality.stress, "edge_length_cv", quality.edge_length_cv,
+                         "neighbourhood_preservation", quality.neighbourhood_preservation,
+                         "crossings_per_edge", quality.crossings_per_edge);
+}
+
+/**
+ * @brief configure(key, value), overrides a value of config.h for everything that runs afterwards (see config_set).
+ */
+static PyObject* py_configure(PyObject*, PyObject* args){
+    const char* key;
+    PyObject* value;
+    if(!PyArg_ParseTuple(args, "sO", &key, &value)){
+        return nullptr;
+    }
+
+    // bools are spelled the way config_set expects them, everything else goes through str()
+    PyObject* text = PyBool_Check(value) ? PyUnicode_FromString(value == Py_True ? "true" : "false") : PyObject_Str(value);
+    if(!text){
+        return nullptr;
+    }
+    const char* value_str = PyUnicode_AsUTF8(text);
+    if(!value_str){
+        Py_DECREF(text);
+        return nullptr;
+    }
+
+    int result = config_set(key, value_str);
+    Py_DECREF(text);
+    if(!result){
+        PyErr_Format(PyExc_ValueError, "could not set '%s'", key);
+        return nullptr;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef module_methods[] = {
+    {"configure", py_configure, METH_VARARGS, "configure(key, value), e.g. configure('fdl-max-iter', 100)."},
+    {"load", py_load, METH_VARARGS, "load(path) -> Graph, reads and prepares a '.txt' edge list."},
+    {"load_bin", py_load_bin, METH_VARARGS, "load_bin(path) -> Graph, reads the '-graph.bin' written for the '.txt' at path."},
+    {"preproc", py_preproc, METH_VARARGS, "preproc(path, communities=True) -> Graph, the full preprocessing, binary outputs included."},
+    {"label_propagation", py_label_propagation, METH_VARARGS, "label_propagation(graph) -> communities (uint16)."},
+    {"rank", py_rank, METH_VARARGS, "rank(graph, algorithm) -> ranks (uint16), algorithm as in config::RANKING_ALGORITHM."},
+    {"triangles", py_triangles, METH_VARARGS, "triangles(graph) -> (total, triangles per vertex, clustering per vertex, global clustering)."},
+    {"layout", py_layout, METH_VARARGS, "layout(graph) -> positions (float64, vertex_nr x 2)."},
+    {"layout_quality", py_layout_quality, METH_VARARGS, "layout_quality(graph, positions) -> dict of sampled stress, edge length cv, neighbourhood preservation and crossings per edge."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT,
+    "graph_explorer",
+    "Zero-copy access to the graph-explorer engines.",
+    -1,
+    module_methods
+};
+
+PyMODINIT_FUNC PyInit_graph_explorer(){
+    import_array();
+
+    PyObject* module = PyModule_Create(&module_def);
+    if(!module){
+        return nullptr;
+    }
+
+    graph_type = PyType_FromSpec(&graph_spec);
+    if(!graph_type){
+        Py_DECREF(module);
+        return nullptr;
+    }
+
+    Py_INCREF(graph_type);
+    if(PyModule_AddObject(module, "Graph", graph_type) < 0){
+        Py_DECREF(graph_type);
+        Py_DECREF(module);
+        return nullptr;
+    }
+
+    PyModule_AddIntConstant(module, "NEIGHBOURHOOD", NEIGHBOURHOOD);
+    PyModule_AddIntConstant(module, "CLUSTERING_COEFFICIENT", CLUSTERING_COEFFICIENT);
+
+    return module;
+}
@@ -0,0 +1,132 @@
+/**
+ * @brief Implements the 'batch' command.
+ *
+ * Every job is a task of one pool. A small graph's pipeline tasks stay on the deque of the worker that runs the job
+ * (which runs them itself while it waits), so small graphs effectively run one per worker. The tasks of a large
+ * graph get stolen by idle workers, so it runs in parallel. The jobs are submitted largest first, so no large graph
+ * is left over for the end.
+ */
+
+#include "batch.h"
+#include "pipeline.h"
+#include "thread-pool.h"
+#include "io-writer.h"
+#include "config.h"
+#include "main.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/**
+ * @brief The edge lists of a directory (every '.txt') or of a manifest.
+ */
+static std::vector<std::string> batch_files(std::string path){
+    std::vector<std::string> files;
+    std::error_code error;
+
+    if(std::filesystem::is_directory(path, error)){
+        for(const auto& entry : std::filesystem::directory_iterator(path, error)){
+            if(entry.is_regular_file() && entry.path().extension() == ".txt"){
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::ifstream manifest(path);
+    if(!manifest.is_open()){
+        std::cerr << "[ERROR] could not open " << path << std::endl;
+        return files;
+    }
+
+    std::string line;
+    while(std::getline(manifest, line)){
+        line = line.substr(0, line.find('#'));
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if(!line.empty()){
+            files.push_back(line);
+        }
+    }
+
+    return files;
+}
+
+int process_batch(std::string path, bool external){
+    std::vector<std::string> files = batch_files(path);
+    if(files.empty()){
+        std::cerr << "batch.cpp: no edge lists found in " << path << std::endl;
+        return 0;
+    }
+
+    // largest first, by file size
+    std::vector<std::pair<uintmax_t, std::string>> jobs;
+    for(const std::string& file : files){
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(file, error);
+        jobs.push_back({error ? 0 : size, file});
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const auto& a, const auto& b){
+        return a.first > b.first;
+    });
+
+    // the progress bars of concurrent jobs would only garble each other
+    SHOW_PROGRESS = false;
+
+    ThreadPool pool(config::PIPELINE_THREADS);
+    IOWriter io;
+    DEBUG_PRINT("Batch of " + std::to_string(jobs.size()) + " jobs on " + std::to_string(pool.get_thread_nr()) + " threads");
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    std::vector<pipeline_stats> stats(jobs.size());
+    std::vector<std::future<int>> done;
+    for(size_t i = 0; i < jobs.size(); i++){
+        std::string file = jobs[i].second;
+        pipeline_stats* job_stats = &stats[i];
+        done.push_back(pool.submit([file, external, &pool, &io, job_stats](){
+            return process_pipeline(file, external, &pool, &io, job_stats);
+        }));
+    }
+
+    // Only blocks: helping through pool.wait would run jobs on this thread, whose own waits (from outside the pool)
+    // could pick up further jobs in turn.
+    std::vector<int> results(jobs.size());
+    for(size_t i = 0; i < jobs.size(); i++){
+        results[i] = done[i].get();
+    }
+    io.wait();
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t1).count();
+    SHOW_PROGRESS = true;
+
+    // summary, in the order the jobs were run
+    uint64_t total_edges = 0;
+    size_t failed = 0;
+    std::cout << std::left << std::setw(40) << "file" << std::right << std::setw(10) << "nodes" << std::setw(12) << "edges"
+              << std::setw(12) << "ms" << std::setw(16) << "edges/s" << std::endl;
+    for(size_t i = 0; i < jobs.size(); i++){
+        std::cout << std::left << std::setw(40) << jobs[i].second << std::right;
+        if(!results[i]){
+            std::cout << "  failed" << std::endl;
+            failed++;
+            continue;
+        }
+
+        total_edges += stats[i].edge_nr;
+        std::cout << std::setw(10) << stats[i].vertex_nr << std::setw(12) << stats[i].edge_nr
+                  << std::setw(12) << (uint64_t)(stats[i].seconds * 1000.0)
+                  << std::setw(16) << (uint64_t)(stats[i].seconds > 0 ? stats[i].edge_nr / stats[i].seconds : 0) << std::endl;
+    }
+
+    std::cout << jobs.size() - failed << " of " << jobs.size() << " jobs in " << (uint64_t)(seconds * 1000.0) << "ms: "
+              << std::fixed << std::setprecision(1) << (jobs.size() - failed) / seconds << " jobs/s, "
+              << (uint64_t)(total_edges / seconds) << " edges/s" << std::defaultfloat << std::endl;
+
+    return failed == 0;
+}
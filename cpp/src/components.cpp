@@ -0,0 +1,400 @@
+/**
+ * @brief This file implements the connected components decomposition used to lay out every component on its
+ * own, and the packing of the resulting layouts into one canvas.
+ */
+
+#include "components.h"
+#include "initial-placement.h"
+#include "thread-pool.h"
+#include "config.h"
+#include "main.h"
+#include <atomic>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+/**
+ * @brief Lock-free find with path halving.
+ */
+static node_int find_root(std::vector<std::atomic<node_int>>& parent, node_int v){
+    while(true){
+        node_int p = parent[v].load();
+        if(p == v){
+            return v;
+        }
+
+        node_int gp = parent[p].load();
+        if(p != gp){
+            parent[v].compare_exchange_weak(p, gp);
+        }
+        v = gp;
+    }
+}
+
+/**
+ * @brief Lock-free union, always hanging the larger root below the smaller one, so the roots end up being the
+ * smallest id of their component.
+ */
+static void unite(std::vector<std::atomic<node_int>>& parent, node_int a, node_int b){
+    while(true){
+        a = find_root(parent, a);
+        b = find_root(parent, b);
+        if(a == b){
+            return;
+        }
+        if(a < b){
+            std::swap(a, b);
+        }
+
+        node_int expected = a;
+        if(parent[a].compare_exchange_strong(expected, b)){
+            return;
+        }
+    }
+}
+
+std::vector<node_int> connected_components(Graph* graph, unsigned thread_nr){
+    const node_int n = graph->get_vertex_nr();
+
+    std::vector<std::atomic<node_int>> parent(n);
+    for(node_int v = 0; v < n; v++){
+        parent[v].store(v);
+    }
+
+    {
+        std::unique_ptr<ThreadPool> own_pool;
+        ThreadPool* pool = current_or_own_pool(own_pool, thread_nr);
+        const size_t chunk_nr = (size_t)pool->get_thread_nr() * 4;
+        const size_t chunk_size = (n + chunk_nr - 1) / chunk_nr;
+
+        std::vector<std::future<void>> done;
+        for(size_t begin = 0; begin < n; begin += chunk_size){
+            size_t end = std::min<size_t>(begin + chunk_size, n);
+            done.push_back(pool->submit([graph, &parent, begin, end](){
+                for(size_t v = begin; v < end; v++){
+                    graph->for_each_neighbor((node_int)v, [&parent, v](node_int u){
+                        // every undirected edge is stored twice, once is enough
+                        if(u > v){
+                            unite(parent, (node_int)v, u);
+                        }
+                    });
+                }
+            }));
+        }
+        for(std::future<void>& f : done){
+            pool->wait(f);
+        }
+    }
+
+    std::vector<node_int> labels(n);
+    for(node_int v = 0; v < n; v++){
+        labels[v] = find_root(parent, v);
+    }
+
+    return labels;
+}
+
+std::vector<std::vector<node_int>> component_members(const std::vector<node_int>& labels){
+    std::vector<std::vector<node_int>> members(labels.size());
+    for(size_t v = 0; v < labels.size(); v++){
+        members[labels[v]].push_back((node_int)v);
+    }
+
+    members.erase(std::remove_if(members.begin(), members.end(), [](const std::vector<node_int>& m){
+        return m.empty();
+    }), members.end());
+
+    std::stable_sort(members.begin(), members.end(), [](const std::vector<node_int>& a, const std::vector<node_int>& b){
+        return a.size() > b.size();
+    });
+
+    return members;
+}
+
+Graph* component_subgraph(Graph* graph, const std::vector<node_int>& members, const std::vector<node_int>& local_ids,
+                          bool with_communities){
+    const node_int n = members.size();
+
+    std::vector<edge_int> offsets(n + 1, 0);
+    std::vector<node_int> communities(n);
+    for(node_int i = 0; i < n; i++){
+        offsets[i + 1] = offsets[i] + graph->get_degree(members[i]);
+        communities[i] = with_communities ? graph->get_communities()[members[i]] : members[i];
+    }
+
+    std::vector<node_int> targets(offsets[n]);
+    for(node_int i = 0; i < n; i++){
+        edge_int write_index = offsets[i];
+        graph->for_each_neighbor(members[i], [&](node_int u){
+            targets[write_index++] = local_ids[u];
+        });
+    }
+
+    const edge_int edge_nr = offsets[n];
+    return new Graph(graph->get_graph_type(), edge_nr, n, std::move(offsets), std::move(targets), std::move(communities));
+}
+
+std::vector<std::pair<double,double>> pack_rectangles(const std::vector<std::pair<double,double>>& sizes){
+    std::vector<std::pair<double,double>> corners(sizes.size());
+    if(sizes.empty()){
+        return corners;
+    }
+
+    std::vector<size_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b){
+        return sizes[a].second > sizes[b].second;
+    });
+
+    // aim for a square canvas, but never narrower than the widest rectangle
+    double total_area = 0.0;
+    double max_width = 0.0;
+    for(const std::pair<double,double>& size : sizes){
+        total_area += size.first * size.second;
+        max_width = std::max(max_width, size.first);
+    }
+    const double canvas_width = std::max(max_width, std::sqrt(total_area));
+
+    double x = 0.0;
+    double y = 0.0;
+    double shelf_height = 0.0;
+    for(size_t i : order){
+        if(x > 0.0 && x + sizes[i].first > canvas_width){
+            // next shelf
+            x = 0.0;
+            y += shelf_height;
+            shelf_height = 0.0;
+        }
+
+        corners[i] = {x, y};
+        x += sizes[i].first;
+        shelf_height = std::max(shelf_height, sizes[i].second);
+    }
+
+    return corners;
+}
+
+/**
+ * @brief Starts the layout of a single component on its own canvas.
+ *
+ * @param       sub_fdl     Set to the layout of the returned subgraph
+ */
+static Graph* start_component(FDL* fdl, Graph* graph, const std::vector<node_int>& members,
+                              const std::vector<node_int>& local_ids, FDL*& sub_fdl){
+    // The label propagation may still be running (see process_pipeline), only a community based start needs its
+    // result, and then it's waited for before the layout starts.
+    const bool communities = (initial_placement)fdl::INITIAL_PLACEMENT == COMMUNITY_PLACEMENT;
+    Graph* sub = component_subgraph(graph, members, local_ids, communities);
+
+    // keep the ideal edge length of the whole layout, so all components end up at the same scale
+    const int side = std::max(1, (int)std::ceil(fdl->k * std::sqrt((double)members.size())));
+    sub_fdl = fdl_start(sub, side, side);
+    return sub;
+}
+
+/**
+ * @brief Copies the positions of a component into the whole layout, unpacked.
+ */
+static void copy_component(FDL* fdl, const std::vector<node_int>& members, FDL* sub_fdl){
+    // every vertex belongs to exactly one component, so the tasks never write the same entry
+    for(size_t i = 0; i < members.size(); i++){
+        fdl->pos[members[i]] = sub_fdl->pos[i];
+    }
+}
+
+/**
+ * @brief Runs all iterations on a single component, without a progress bar as many of them run at once.
+ */
+static void layout_component(FDL* fdl, Graph* graph, const std::vector<node_int>& members, const std::vector<node_int>& local_ids){
+    FDL* sub_fdl;
+    Graph* sub = start_component(fdl, graph, members, local_ids, sub_fdl);
+    for(int iteration = 1; iteration <= sub_fdl->max_iter; iteration++){
+        fdl_iteration(sub_fdl, sub, iteration);
+    }
+    copy_component(fdl, members, sub_fdl);
+
+    delete sub_fdl;
+    delete sub;
+}
+
+/**
+ * @brief Moves the components, each laid out around its own origin in fdl->pos, next to each other.
+ */
+static void pack_components(FDL* fdl, const std::vector<std::vector<node_int>>& members){
+    // bounding box of every component that is drawn, with half an edge length of margin on each side
+    std::vector<size_t> packed;
+    std::vector<std::pair<double,double>> low;
+    std::vector<std::pair<double,double>> sizes;
+    for(size_t c = 0; c < members.size(); c++){
+        if(members[c].size() == 1){
+            fdl->pos[members[c][0]] = {0.0, 0.0};
+            if(!fdl::SHOW_ISOLATED_NODES_JSON){
+                continue;
+            }
+        }
+
+        std::pair<double,double> min = fdl->pos[members[c][0]];
+        std::pair<double,double> max = min;
+        for(node_int v : members[c]){
+            min = {std::min(min.first, fdl->pos[v].first), std::min(min.second, fdl->pos[v].second)};
+            max = {std::max(max.first, fdl->pos[v].first), std::max(max.second, fdl->pos[v].second)};
+        }
+
+        packed.push_back(c);
+        low.push_back(min);
+        sizes.push_back({max.first - min.first + fdl->k, max.second - min.second + fdl->k});
+    }
+
+    std::vector<std::pair<double,double>> corners = pack_rectangles(sizes);
+
+    // center the packed canvas on (0,0), like the single layout
+    double canvas_x = 0.0;
+    double canvas_y = 0.0;
+    for(size_t i = 0; i < packed.size(); i++){
+        canvas_x = std::max(canvas_x, corners[i].first + sizes[i].first);
+        canvas_y = std::max(canvas_y, corners[i].second + sizes[i].second);
+    }
+
+    for(size_t i = 0; i < packed.size(); i++){
+        const double shift_x = corners[i].first  - low[i].first  + fdl->k / 2.0 - canvas_x / 2.0;
+        const double shift_y = corners[i].second - low[i].second + fdl->k / 2.0 - canvas_y / 2.0;
+        for(node_int v : members[packed[i]]){
+            fdl->pos[v].first  += shift_x;
+            fdl->pos[v].second += shift_y;
+        }
+    }
+}
+
+/**
+ * @brief Runs the components in lockstep, one task per batch and iteration, so the packed positions can be
+ * recorded every stride. Keeps all subgraphs alive at once, which is why it's only done while recording.
+ */
+static void record_components(FDL* fdl, Graph* graph, const std::vector<std::vector<node_int>>& members,
+                              const std::vector<node_int>& local_ids, const std::vector<std::vector<size_t>>& batches,
+                              ThreadPool* pool, FrameRecorder* recorder){
+    std::vector<Graph*> subs(members.size(), nullptr);
+    std::vector<FDL*> sub_fdls(members.size(), nullptr);
+
+    auto run_batches = [&batches, pool](auto f){
+        std::vector<std::future<void>> done;
+        for(const std::vector<size_t>& batch : batches){
+            done.push_back(pool->submit([&f, &batch](){
+                for(size_t c : batch){
+                    f(c);
+                }
+            }));
+        }
+        for(std::future<void>& d : done){
+            pool->wait(d);
+        }
+    };
+    auto assemble = [&](){
+        for(const std::vector<size_t>& batch : batches){
+            for(size_t c : batch){
+                copy_component(fdl, members[c], sub_fdls[c]);
+            }
+        }
+        pack_components(fdl, members);
+    };
+
+    run_batches([&](size_t c){ subs[c] = start_component(fdl, graph, members[c], local_ids, sub_fdls[c]); });
+    // every component gets the same iteration count, taking the maximum just doesn't depend on that
+    int max_iter = 0;
+    for(const std::vector<size_t>& batch : batches){
+        for(size_t c : batch){
+            max_iter = std::max(max_iter, sub_fdls[c]->max_iter);
+        }
+    }
+
+    assemble();
+    recorder->record(0, fdl->pos);
+    for(int iteration = 1; iteration <= max_iter; iteration++){
+        run_batches([&sub_fdls, &subs, iteration](size_t c){
+            if(iteration <= sub_fdls[c]->max_iter){
+                fdl_iteration(sub_fdls[c], subs[c], iteration);
+            }
+        });
+        print_progress_bar((double)iteration / max_iter);
+
+        // the final frame is recorded by the caller, once the components are packed for good
+        if(iteration % recorder->get_stride() == 0 && iteration < max_iter){
+            assemble();
+            recorder->record(iteration, fdl->pos);
+        }
+    }
+    if(SHOW_PROGRESS){
+        std::cout << std::endl;
+    }
+
+    for(const std::vector<size_t>& batch : batches){
+        for(size_t c : batch){
+            copy_component(fdl, members[c], sub_fdls[c]);
+            delete sub_fdls[c];
+            delete subs[c];
+        }
+    }
+}
+
+void fdl_layout_components(FDL* fdl, Graph* graph, FrameRecorder* recorder){
+    const node_int n = graph->get_vertex_nr();
+    std::vector<std::vector<node_int>> members = component_members(connected_components(graph, config::PIPELINE_THREADS));
+    DEBUG_PRINT("Components: " + std::to_string(members.size()));
+
+    std::vector<node_int> local_ids(n);
+    for(const std::vector<node_int>& component : members){
+        for(size_t i = 0; i < component.size(); i++){
+            local_ids[component[i]] = i;
+        }
+    }
+
+    // large components get a task each, small ones are batched (members is sorted by size, largest first)
+    std::vector<std::vector<size_t>> batches;
+    size_t batch_nodes = fdl::COMPONENT_BATCH_NODES;
+    // the progress only counts these, singletons (and unused ids) aren't laid out
+    size_t laid_out_nr = 0;
+    for(size_t c = 0; c < members.size() && members[c].size() > 1; c++){
+        if(batch_nodes >= (size_t)fdl::COMPONENT_BATCH_NODES){
+            batches.emplace_back();
+            batch_nodes = 0;
+        }
+        batches.back().push_back(c);
+        batch_nodes += members[c].size();
+        laid_out_nr += members[c].size();
+    }
+
+    {
+        std::unique_ptr<ThreadPool> own_pool;
+        ThreadPool* pool = current_or_own_pool(own_pool, config::PIPELINE_THREADS);
+        if(recorder){
+            record_components(fdl, graph, members, local_ids, batches, pool, recorder);
+        }
+        else{
+            std::vector<std::future<size_t>> done;
+            for(const std::vector<size_t>& batch : batches){
+                done.push_back(pool->submit([fdl, graph, &members, &local_ids, &batch](){
+                    size_t node_nr = 0;
+                    for(size_t c : batch){
+                        layout_component(fdl, graph, members[c], local_ids);
+                        node_nr += members[c].size();
+                    }
+                    return node_nr;
+                }));
+            }
+
+            size_t finished = 0;
+            for(std::future<size_t>& f : done){
+                finished += pool->wait(f);
+                print_progress_bar((double)finished / laid_out_nr);
+            }
+            if(SHOW_PROGRESS){
+                std::cout << std::endl;
+            }
+        }
+    }
+
+    pack_components(fdl, members);
+
+    if(recorder){
+        recorder->record(fdl->max_iter, fdl->pos, true);
+    }
+}
@@ -0,0 +1,57 @@
+/**
+ * @brief Implements the delta + varint encoding behind CompressedAdjacency.
+ */
+
+#include "graph.h"
+#include <algorithm>
+
+static inline void put_varint(std::vector<uint8_t>& bytes, uint64_t value){
+    while(value >= 0x80){
+        bytes.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((uint8_t)value);
+}
+
+void append_neighbors(std::vector<uint64_t>& byte_offsets, std::vector<uint8_t>& bytes, std::vector<node_int>& neighbors){
+    std::sort(neighbors.begin(), neighbors.end());
+    put_varint(bytes, neighbors.size());
+    uint32_t previous = 0;
+    for(node_int u : neighbors){
+        put_varint(bytes, (uint32_t)u - previous);
+        previous = u;
+    }
+    byte_offsets.push_back(bytes.size());
+}
+
+CompressedAdjacency compress_adjacency(const std::vector<edge_int>& offsets, const std::vector<node_int>& targets){
+    const size_t vertex_nr = offsets.size() - 1;
+
+    std::vector<uint64_t> byte_offsets;
+    byte_offsets.reserve(vertex_nr + 1);
+    byte_offsets.push_back(0);
+    std::vector<uint8_t> bytes;
+    // most gaps and lengths take a single byte, so this is usually close to the final size
+    bytes.reserve(targets.size() + vertex_nr);
+
+    std::vector<node_int> neighbors;
+    for(size_t v = 0; v < vertex_nr; v++){
+        neighbors.assign(targets.begin() + offsets[v], targets.begin() + offsets[v + 1]);
+        append_neighbors(byte_offsets, bytes, neighbors);
+    }
+    bytes.shrink_to_fit();
+
+    return CompressedAdjacency(std::move(byte_offsets), std::move(bytes));
+}
+
+std::vector<uint64_t>& CompressedAdjacency::get_byte_offsets(){
+    return byte_offsets;
+}
+
+std::vector<uint8_t>& CompressedAdjacency::get_bytes(){
+    return bytes;
+}
+
+size_t CompressedAdjacency::size_in_bytes() const {
+    return bytes.size() * sizeof(uint8_t) + byte_offsets.size() * sizeof(uint64_t);
+}
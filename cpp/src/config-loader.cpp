@@ -0,0 +1,282 @@
+/**
+ * @brief Implements the runtime overrides of the values in config.h.
+ */
+
+#include "config-loader.h"
+#include "config.h"
+#include "main.h"
+#include "ranking.h"
+#include "reorder.h"
+#include "initial-placement.h"
+#include "frame-recorder.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cctype>
+#include <limits>
+
+enum config_value_type{
+    CONFIG_BOOL,
+    // int of at least min, e.g. a canvas size or an iteration count
+    CONFIG_INT,
+    // int selecting an enum value, only the implemented ones (min to max) are accepted
+    CONFIG_CHOICE,
+    CONFIG_UNSIGNED,
+    CONFIG_UINT64,
+    // uint64_t with an optional K, M or G suffix (powers of 1024)
+    CONFIG_BYTES,
+    CONFIG_SIZE,
+    CONFIG_DOUBLE
+};
+
+struct config_entry{
+    std::string key;
+    config_value_type type;
+    void* value;
+    int min = std::numeric_limits<int>::min();
+    int max = std::numeric_limits<int>::max();
+};
+
+static const std::vector<config_entry> entries = {
+    {"max-prop-iter",               CONFIG_INT,         &config::MAX_PROP_ITER,         0},
+    {"prop-steps-per-iter",         CONFIG_INT,         &config::PROP_STEPS_PER_ITER,   0},
+    {"ranking-algorithm",           CONFIG_CHOICE,      &config::RANKING_ALGORITHM,     NEIGHBOURHOOD,  CLUSTERING_COEFFICIENT},
+    {"ranking-iterations",          CONFIG_INT,         &config::RANKING_ITERATIONS,    0},
+    {"reorder-algorithm",           CONFIG_CHOICE,      &config::REORDER_ALGORITHM,     NO_REORDER,     COMMUNITY_CONTIGUOUS},
+    {"compress-adjacency",          CONFIG_BOOL,        &config::COMPRESS_ADJACENCY},
+    {"external-memory-budget",      CONFIG_BYTES,       &config::EXTERNAL_MEMORY_BUDGET},
+    {"memory-budget",               CONFIG_BYTES,       &config::MEMORY_BUDGET},
+    {"external-merge-fanin",        CONFIG_SIZE,        &config::EXTERNAL_MERGE_FANIN},
+    {"pipeline-threads",            CONFIG_UNSIGNED,    &config::PIPELINE_THREADS},
+    {"seed",                        CONFIG_UNSIGNED,    &config::SEED},
+    {"write-clustering",            CONFIG_BOOL,        &config::WRITE_CLUSTERING},
+    {"show-isolated-nodes-json",    CONFIG_BOOL,        &fdl::SHOW_ISOLATED_NODES_JSON},
+    {"include-neighbours-json",     CONFIG_BOOL,        &fdl::INCLUDE_NEIGHBOURS_JSON},
+    {"include-rank-json",           CONFIG_BOOL,        &fdl::INCLUDE_RANK_JSON},
+    {"include-clustering-json",     CONFIG_BOOL,        &fdl::INCLUDE_CLUSTERING_JSON},
+    {"fdl-max-iter",                CONFIG_INT,         &fdl::FDL_MAX_ITER,             0},
+    {"width",                       CONFIG_INT,         &fdl::WIDTH,                    1},
+    {"height",                      CONFIG_INT,         &fdl::HEIGHT,                   1},
+    {"fdl-start-temp",              CONFIG_DOUBLE,      &fdl::FDL_START_TEMP},
+    {"gravity-strength",            CONFIG_DOUBLE,      &fdl::GRAVITY_STRENGTH},
+    {"initial-placement",           CONFIG_CHOICE,      &fdl::INITIAL_PLACEMENT,        RANDOM_PLACEMENT, COMMUNITY_PLACEMENT},
+    {"pivot-nr",                    CONFIG_INT,         &fdl::PIVOT_NR,                 2},
+    {"placed-max-iter",             CONFIG_INT,         &fdl::PLACED_MAX_ITER,          0},
+    {"placed-start-temp-factor",    CONFIG_DOUBLE,      &fdl::PLACED_START_TEMP_FACTOR},
+    {"write-spatial-index",         CONFIG_BOOL,        &fdl::WRITE_SPATIAL_INDEX},
+    {"record-frames",               CONFIG_BOOL,        &fdl::RECORD_FRAMES},
+    {"record-stride",               CONFIG_INT,         &fdl::RECORD_STRIDE,            1},
+    {"record-precision",            CONFIG_CHOICE,      &fdl::RECORD_PRECISION,         FRAME_FLOAT32,  FRAME_DELTA16},
+    {"layout-by-component",         CONFIG_BOOL,        &fdl::LAYOUT_BY_COMPONENT},
+    {"component-batch-nodes",       CONFIG_INT,         &fdl::COMPONENT_BATCH_NODES,    1},
+    {"evaluate-seeds",              CONFIG_INT,         &fdl::EVALUATE_SEEDS,           1},
+    {"evaluate-sources",            CONFIG_INT,         &fdl::EVALUATE_SOURCES,         1},
+    {"evaluate-samples",            CONFIG_INT,         &fdl::EVALUATE_SAMPLES,         1}
+};
+
+// Whether fdl-start-temp was set explicitly, otherwise it follows the height.
+static bool start_temp_set = false;
+
+/**
+ * @brief Parses value into the variable behind entry, the whole string has to be consumed.
+ */
+static bool parse_value(const config_entry& entry, const std::string& value){
+    size_t end = 0;
+    try{
+        switch(entry.type){
+            case CONFIG_BOOL:
+                if(value == "true" || value == "1"){
+                    *(bool*)entry.value = true;
+                }
+                else if(value == "false" || value == "0"){
+                    *(bool*)entry.value = false;
+                }
+                else{
+                    return false;
+                }
+                return true;
+            case CONFIG_INT:
+            case CONFIG_CHOICE:{
+                int parsed = std::stoi(value, &end);
+                if(parsed < entry.min || parsed > entry.max){
+                    return false;
+                }
+                *(int*)entry.value = parsed;
+                break;
+            }
+            case CONFIG_UNSIGNED:
+            case CONFIG_UINT64:
+            case CONFIG_BYTES:
+            case CONFIG_SIZE:{
+                // stoull happily wraps negative numbers around
+                if(value.find('-') != std::string::npos){
+                    return false;
+                }
+                unsigned long long parsed = std::stoull(value, &end);
+                if(entry.type == CONFIG_UNSIGNED){
+                    *(unsigned*)entry.value = parsed;
+                }
+                else if(entry.type == CONFIG_UINT64){
+                    *(uint64_t*)entry.value = parsed;
+                }
+                else if(entry.type == CONFIG_BYTES){
+                    const std::string units = "KMG";
+                    size_t unit = end < value.size() ? units.find(std::toupper(value[end])) : std::string::npos;
+                    if(unit != std::string::npos){
+                        const int shift = 10 * (unit + 1);
+                        if(parsed > (std::numeric_limits<uint64_t>::max() >> shift)){
+                            return false;
+                        }
+                        parsed <<= shift;
+                        end++;
+                    }
+                    *(uint64_t*)entry.value = parsed;
+                }
+                else{
+                    *(size_t*)entry.value = parsed;
+                }
+                break;
+            }
+            case CONFIG_DOUBLE:
+                *(double*)entry.value = std::stod(value, &end);
+                break;
+        }
+    }
+    catch(const std::exception&){
+        return false;
+    }
+
+    return end == value.size();
+}
+
+static std::string trim(const std::string& str){
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if(begin == std::string::npos){
+        return "";
+    }
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+int config_set(std::string key, std::string value){
+    key = trim(key);
+    value = trim(value);
+
+    for(const config_entry& entry : entries){
+        if(entry.key != key){
+            continue;
+        }
+
+        if(!parse_value(entry, value)){
+            std::cerr << "config-loader.cpp: invalid value '" << value << "' for " << key;
+            if(entry.type == CONFIG_CHOICE){
+                std::cerr << " (expected " << entry.min << " to " << entry.max << ")";
+            }
+            else if(entry.type == CONFIG_INT){
+                std::cerr << " (expected at least " << entry.min << ")";
+            }
+            std::cerr << std::endl;
+            return 0;
+        }
+
+        if(key == "fdl-start-temp"){
+            start_temp_set = true;
+        }
+        else if(key == "height" && !start_temp_set){
+            fdl::FDL_START_TEMP = fdl::HEIGHT/10;
+        }
+
+        return 1;
+    }
+
+    std::cerr << "config-loader.cpp: unknown setting '" << key << "'" << std::endl;
+    return 0;
+}
+
+int config_from_file(std::string file_name){
+    std::ifstream file(file_name);
+    if(!file.is_open()){
+        std::cerr << "[ERROR] could not open " << file_name << std::endl;
+        return 0;
+    }
+
+    std::string line;
+    while(std::getline(file, line)){
+        line = trim(line.substr(0, line.find('#')));
+        if(line.empty()){
+            continue;
+        }
+
+        size_t separator = line.find('=');
+        if(separator == std::string::npos){
+            std::cerr << "config-loader.cpp: expected 'key = value' in " << file_name << ", got '" << line << "'" << std::endl;
+            return 0;
+        }
+        if(!config_set(line.substr(0, separator), line.substr(separator + 1))){
+            return 0;
+        }
+    }
+
+    DEBUG_PRINT("Read config: " + file_name);
+    return 1;
+}
+
+int config_from_args(int argc, char* argv[]){
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--config"){
+            if(i + 1 >= argc){
+                std::cerr << "config-loader.cpp: --config needs a file" << std::endl;
+                return 0;
+            }
+            if(!config_from_file(argv[++i])){
+                return 0;
+            }
+        }
+    }
+
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--config"){
+            i++;
+            continue;
+        }
+        if(arg.rfind("--", 0) != 0){
+            continue;
+        }
+
+        size_t separator = arg.find('=');
+        if(separator == std::string::npos){
+            std::cerr << "config-loader.cpp: expected --key=value, got '" << arg << "'" << std::endl;
+            return 0;
+        }
+        if(!config_set(arg.substr(2, separator - 2), arg.substr(separator + 1))){
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+unsigned config_seed(){
+    static const unsigned clock_seed = (unsigned)std::chrono::system_clock::now().time_since_epoch().count();
+    return config::SEED != 0 ? config::SEED : clock_seed;
+}
+
+void config_print(){
+    for(const config_entry& entry : entries){
+        std::string value;
+        switch(entry.type){
+            case CONFIG_BOOL:       value = *(bool*)entry.value ? "true" : "false"; break;
+            case CONFIG_INT:
+            case CONFIG_CHOICE:     value = std::to_string(*(int*)entry.value); break;
+            case CONFIG_UNSIGNED:   value = std::to_string(*(unsigned*)entry.value); break;
+            case CONFIG_UINT64:
+            case CONFIG_BYTES:      value = std::to_string(*(uint64_t*)entry.value); break;
+            case CONFIG_SIZE:       value = std::to_string(*(size_t*)entry.value); break;
+            case CONFIG_DOUBLE:     value = std::to_string(*(double*)entry.value); break;
+        }
+        DEBUG_PRINT(entry.key + " = " + value);
+    }
+}
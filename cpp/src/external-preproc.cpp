@@ -0,0 +1,284 @@
+/**
+ * @brief Builds the '-graph.bin' of an edge list that does not fit into memory (external memory sort).
+ *
+ * The text is streamed into runs of at most memory_budget / 2 bytes of (source, target) pairs, each sorted and
+ * spilled to a temporary file. The degrees are counted on the way, which gives the offsets section up front.
+ * The runs are then k-way merged (in several passes if there are more than config::EXTERNAL_MERGE_FANIN of them)
+ * and the last pass streams the targets section straight into the binary, sorted by source and then target.
+ */
+
+#include "external-preproc.h"
+#include "preproc.h"
+#include "config.h"
+#include "main.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+
+typedef std::pair<node_int, node_int> edge_pair;
+
+static std::string run_name(std::string dir, uint64_t run){
+    return dir.substr(0, dir.size() - 4) + "-run-" + std::to_string(run) + ".tmp";
+}
+
+/**
+ * @brief Removes the given (temporary) files, e.g. the runs left when the build fails.
+ */
+static void remove_files(const std::vector<std::string>& names){
+    std::error_code error;
+    for(const std::string& name : names){
+        std::filesystem::remove(name, error);
+    }
+}
+
+/**
+ * @brief Buffered sequential reader over one sorted run.
+ */
+class run_reader{
+    public:
+        run_reader(std::string name, size_t buffer_size, external_io_stats& stats)
+            : file(name, std::ios::binary), buffer(buffer_size), stats(stats){}
+
+        bool next(edge_pair& edge){
+            if(position == filled){
+                file.read((char*)buffer.data(), buffer.size() * sizeof(edge_pair));
+                filled = file.gcount() / sizeof(edge_pair);
+                position = 0;
+                stats.runs_read += filled * sizeof(edge_pair);
+                if(filled == 0){
+                    return false;
+                }
+            }
+
+            edge = buffer[position++];
+            return true;
+        }
+
+    private:
+        std::ifstream file;
+        std::vector<edge_pair> buffer;
+        size_t position = 0;
+        size_t filled = 0;
+        external_io_stats& stats;
+};
+
+/**
+ * @brief Merges the given runs, handing every pair in sorted order to emit.
+ */
+static void merge_runs(const std::vector<std::string>& names, size_t buffer_size, external_io_stats& stats,
+                       const std::function<void(const edge_pair&)>& emit){
+    std::vector<run_reader*> readers;
+    typedef std::pair<edge_pair, size_t> heap_entry;
+    std::priority_queue<heap_entry, std::vector<heap_entry>, std::greater<heap_entry>> heap;
+
+    for(size_t r = 0; r < names.size(); r++){
+        readers.push_back(new run_reader(names[r], buffer_size, stats));
+        edge_pair edge;
+        if(readers[r]->next(edge)){
+            heap.push({edge, r});
+        }
+    }
+
+    while(!heap.empty()){
+        heap_entry top = heap.top();
+        heap.pop();
+        emit(top.first);
+
+        edge_pair edge;
+        if(readers[top.second]->next(edge)){
+            heap.push({edge, top.second});
+        }
+    }
+
+    for(run_reader* reader : readers){
+        delete reader;
+    }
+}
+
+/**
+ * @brief Converts the text edge list at dir into its '-graph.bin' without ever holding the edges in memory.
+ *
+ * @param       dir             The directory of the file we want to convert
+ * @param       memory_budget   Roughly the memory (in bytes) the conversion may use, apart from the degree counters
+ * @param       stats           If set, receives the I/O volume
+ */
+int txt_to_bin_external(std::string dir, uint64_t memory_budget, external_io_stats* stats){
+    external_io_stats local_stats;
+    external_io_stats& io = stats ? *stats : local_stats;
+
+    std::ifstream in_file(dir);
+    if(!in_file.is_open()){
+        std::cerr << "external-preproc.cpp: could not open " << dir << std::endl;
+        return 0;
+    }
+
+    // half of the budget goes to the run buffer, the other half to the stream buffers of the merge
+    const size_t run_capacity = std::max<size_t>(memory_budget / 2 / sizeof(edge_pair), 1024);
+    std::vector<edge_pair> run;
+    run.reserve(run_capacity);
+
+    std::vector<edge_int> degrees((size_t)std::numeric_limits<node_int>::max() + 1, 0);
+    std::vector<std::string> run_names;
+    uint64_t max_id = 0;
+    uint64_t edge_nr = 0;
+
+    auto flush_run = [&](){
+        std::sort(run.begin(), run.end());
+
+        std::string name = run_name(dir, run_names.size());
+        run_names.push_back(name);
+        std::ofstream run_file(name, std::ios::binary);
+        run_file.write((char*)run.data(), run.size() * sizeof(edge_pair));
+        run_file.close();
+        if(!run_file){
+            std::cerr << "[ERROR] could not write " << name << std::endl;
+            return 0;
+        }
+
+        io.runs_written += run.size() * sizeof(edge_pair);
+        run.clear();
+        return 1;
+    };
+
+    std::string line;
+    node_int idA;
+    node_int idB;
+    while(std::getline(in_file, line)){
+        io.text_read += line.size() + 1;
+        if(!parse_edge(line, idA, idB)){
+            continue;
+        }
+
+        run.push_back({idA, idB});
+        run.push_back({idB, idA}); // for undirected
+        degrees[idA]++;
+        degrees[idB]++;
+        max_id = std::max<uint64_t>(max_id, std::max(idA, idB));
+        edge_nr += 2;
+
+        if(run.size() + 2 > run_capacity && !flush_run()){
+            remove_files(run_names);
+            return 0;
+        }
+    }
+    in_file.close();
+    if(!run.empty() && !flush_run()){
+        remove_files(run_names);
+        return 0;
+    }
+    run.clear();
+    run.shrink_to_fit();
+    io.run_nr = run_names.size();
+
+    // Merge passes until the remaining runs can be merged at once.
+    const size_t fanin = std::max<size_t>(2, config::EXTERNAL_MERGE_FANIN);
+    while(run_names.size() > fanin){
+        io.merge_passes++;
+        std::vector<std::string> merged_names;
+        const size_t buffer_size = std::max<size_t>(memory_budget / 2 / (fanin + 1) / sizeof(edge_pair), 256);
+
+        for(size_t first = 0; first < run_names.size(); first += fanin){
+            std::vector<std::string> group(run_names.begin() + first, run_names.begin() + std::min(first + fanin, run_names.size()));
+
+            std::string name = dir.substr(0, dir.size() - 4) + "-run-" + std::to_string(io.merge_passes) + "-"
+                               + std::to_string(merged_names.size()) + ".tmp";
+            std::ofstream merged(name, std::ios::binary);
+            std::vector<edge_pair> out_buffer;
+            out_buffer.reserve(buffer_size);
+
+            merge_runs(group, buffer_size, io, [&](const edge_pair& edge){
+                out_buffer.push_back(edge);
+                if(out_buffer.size() == buffer_size){
+                    merged.write((char*)out_buffer.data(), out_buffer.size() * sizeof(edge_pair));
+                    io.runs_written += out_buffer.size() * sizeof(edge_pair);
+                    out_buffer.clear();
+                }
+            });
+            merged.write((char*)out_buffer.data(), out_buffer.size() * sizeof(edge_pair));
+            io.runs_written += out_buffer.size() * sizeof(edge_pair);
+            merged.close();
+            merged_names.push_back(name);
+            if(!merged){
+                std::cerr << "[ERROR] could not write " << name << std::endl;
+                remove_files(run_names);
+                remove_files(merged_names);
+                return 0;
+            }
+
+            for(const std::string& old_name : group){
+                std::filesystem::remove(old_name);
+            }
+        }
+
+        run_names = merged_names;
+    }
+
+    // Header and offsets, in the format of graph_to_bin.
+    std::string out_name = dir.substr(0, dir.size() - 4) + "-graph.bin";
+    std::ofstream out(out_name, std::ios::binary);
+    if(!out.is_open()){
+        std::cerr << "[ERROR] could not open " << out_name << " for writing\n";
+        remove_files(run_names);
+        return 0;
+    }
+
+    uint8_t type_block = 0x00;
+    uint8_t version_block = 0x00;
+    uint64_t node_count_block = run_names.empty() ? 0 : max_id + 1;
+    uint64_t edge_count_block = edge_nr;
+    out.write((char*)&type_block, sizeof(uint8_t));
+    out.write((char*)&version_block, sizeof(uint8_t));
+    out.write((char*)&node_count_block, sizeof(uint64_t));
+    out.write((char*)&edge_count_block, sizeof(uint64_t));
+    io.graph_written += 2 * sizeof(uint8_t) + 2 * sizeof(uint64_t);
+
+    edge_int offset = 0;
+    out.write((char*)&offset, sizeof(edge_int));
+    for(uint64_t v = 0; v < node_count_block; v++){
+        offset += degrees[v];
+        out.write((char*)&offset, sizeof(edge_int));
+    }
+    io.graph_written += (node_count_block + 1) * sizeof(edge_int);
+    degrees.clear();
+    degrees.shrink_to_fit();
+
+    // Final merge, streaming the targets.
+    const size_t buffer_size = std::max<size_t>(memory_budget / 2 / (run_names.size() + 1) / sizeof(edge_pair), 256);
+    std::vector<node_int> targets;
+    targets.reserve(buffer_size);
+    merge_runs(run_names, buffer_size, io, [&](const edge_pair& edge){
+        targets.push_back(edge.second);
+        if(targets.size() == buffer_size){
+            out.write((char*)targets.data(), targets.size() * sizeof(node_int));
+            io.graph_written += targets.size() * sizeof(node_int);
+            targets.clear();
+        }
+    });
+    out.write((char*)targets.data(), targets.size() * sizeof(node_int));
+    io.graph_written += targets.size() * sizeof(node_int);
+    out.close();
+
+    remove_files(run_names);
+    if(!out){
+        // a partial binary would be read as a (truncated) graph
+        std::cerr << "[ERROR] could not write " << out_name << std::endl;
+        remove_files({out_name});
+        return 0;
+    }
+
+    // the ids in the new binary are the ones of the input file
+    std::error_code error;
+    std::filesystem::remove(dir.substr(0, dir.size() - 4) + "-order.bin", error);
+
+    std::cout << "External build: " << edge_nr << " directed edges in " << io.run_nr << " runs, "
+              << io.merge_passes << " extra merge passes" << std::endl;
+    std::cout << "  I/O: read " << io.text_read << " B text, wrote " << io.runs_written << " B runs, read "
+              << io.runs_read << " B runs, wrote " << io.graph_written << " B graph" << std::endl;
+
+    return 1;
+}
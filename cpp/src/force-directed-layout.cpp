@@ -5,6 +5,10 @@
 #include "force-directed-layout.h"
 #include "main.h"
 #include "config.h"
+#include "components.h"
+#include "kernel-dispatch.h"
+#include "initial-placement.h"
+#include "config-loader.h"
 
 /**
  * @brief Implements the Quadtree used for improving the runtime of the FDL algorithm.
@@ -218,7 +222,23 @@ static inline double length(double dx, double dy) {
     return std::hypot(dx, dy);
 }
 
-void fdl_iteration(FDL *fdl, Graph* graph, int iteration){
+/**
+ * @brief A small offset in [-0.5e-3, 0.5e-3) for pulling apart two nodes on the same spot. It is a hash of the pair
+ * rather than std::rand, so that layouts stay reproducible (and thread safe) when components run in parallel.
+ */
+static inline double jitter(node_int v, node_int u, uint32_t axis){
+    uint32_t h = ((uint32_t)v * 2654435761u) ^ ((uint32_t)u * 2246822519u) ^ (axis * 3266489917u);
+    h ^= h >> 15;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    return ((double)h / 4294967296.0 - 0.5) * 1e-3;
+}
+
+/**
+ * @brief One iteration, instantiated per graph type, adjacency representation and whether gravity is on, so none of
+ * them is tested inside the loops.
+ */
+template<graph_type TYPE, bool COMPRESSED, bool GRAVITY> static void fdl_iteration_kernel(FDL *fdl, Graph* graph, int iteration){
     const double EPS = 1e-9;
     const node_int n = graph->get_vertex_nr();
 
@@ -237,8 +257,8 @@ void fdl_iteration(FDL *fdl, Graph* graph, int iteration){
             double d  = length(dx, dy);
 
             if(d < EPS) {
-                dx = ((double)std::rand() / RAND_MAX - 0.5) * 1e-3;
-                dy = ((double)std::rand() / RAND_MAX - 0.5) * 1e-3;
+                dx = jitter(v, u, 0);
+                dy = jitter(v, u, 1);
                 d = length(dx, dy);
                 if (d < EPS) continue;
             }
@@ -253,23 +273,22 @@ void fdl_iteration(FDL *fdl, Graph* graph, int iteration){
     }
 
     // attractive forces
-    std::vector<std::vector<node_int>> adj_matrix = graph->get_adj_matrix();
     for(node_int v = 0; v < (node_int)n; ++v){
-        for(node_int u : adj_matrix[v]) {
-            if (u == v) continue;
+        graph->template for_each_neighbor_as<COMPRESSED>(v, [&](node_int u) {
+            if (u == v) return;
             double dx = fdl->pos[v].first  - fdl->pos[u].first;
             double dy = fdl->pos[v].second - fdl->pos[u].second;
             double d  = length(dx, dy);
 
             if(d < EPS) {
-                dx = ((double)std::rand() / RAND_MAX - 0.5) * 1e-3;
-                dy = ((double)std::rand() / RAND_MAX - 0.5) * 1e-3;
+                dx = jitter(v, u, 0);
+                dy = jitter(v, u, 1);
                 d = length(dx, dy);
-                if (d < EPS) continue;
+                if (d < EPS) return;
             }
 
             double force;
-            if(graph->get_graph_type() == UNDIRECTED) {
+            if constexpr(TYPE == UNDIRECTED) {
                 force = f_att(d, fdl->k) / 2.0; // undirected edges counted twice
             }
             else{
@@ -282,14 +301,16 @@ void fdl_iteration(FDL *fdl, Graph* graph, int iteration){
             fdl->dis[v].second -= uy * force;
             fdl->dis[u].first  += ux * force;
             fdl->dis[u].second += uy * force;
-        }
+        });
     }
 
     // quadratic gravity toward the center
-    const double gravity_strength = fdl::GRAVITY_STRENGTH;
-    for(node_int v = 0; v < n; ++v){
-        fdl->dis[v].first  += -fdl->pos[v].first  * gravity_strength;
-        fdl->dis[v].second += -fdl->pos[v].second * gravity_strength;
+    if constexpr(GRAVITY){
+        const double gravity_strength = fdl::GRAVITY_STRENGTH;
+        for(node_int v = 0; v < n; ++v){
+            fdl->dis[v].first  += -fdl->pos[v].first  * gravity_strength;
+            fdl->dis[v].second += -fdl->pos[v].second * gravity_strength;
+        }
     }
 
     // apply displacements
@@ -321,7 +342,15 @@ void fdl_iteration(FDL *fdl, Graph* graph, int iteration){
     }
 
     // cool down
-    fdl->temp = fdl::FDL_START_TEMP * (1.0 - (double)iteration / (double)fdl::FDL_MAX_ITER);
+    fdl->temp = fdl->start_temp * (1.0 - (double)iteration / (double)fdl->max_iter);
+}
+
+void fdl_iteration(FDL *fdl, Graph* graph, int iteration){
+    dispatch_graph(graph, [&](auto type, auto compressed){
+        dispatch_flag(fdl::GRAVITY_STRENGTH != 0.0, [&](auto gravity){
+            fdl_iteration_kernel<decltype(type)::value, decltype(compressed)::value, decltype(gravity)::value>(fdl, graph, iteration);
+        });
+    });
 }
 
 
@@ -344,114 +373,144 @@ FDL *fdl_start(Graph* graph){
 }
 */
 
-FDL *fdl_start(Graph* graph){
+FDL *fdl_start(Graph* graph, bool by_component){
+    return fdl_start(graph, fdl::WIDTH, fdl::HEIGHT, by_component);
+}
+
+/**
+ * @brief Starts a layout on a canvas of the given size, e.g. a single component sized to its number of nodes.
+ *
+ * @param       by_component    The layout will run per component (see fdl_layout), which places every component
+ *                              on its own. The whole graph then only gets a random start instead of e.g. a pivot MDS.
+ */
+FDL *fdl_start(Graph* graph, int width, int height, bool by_component){
     node_int node_count = graph->get_vertex_nr();
     std::vector<std::pair<double,double>> pos(node_count);
     std::vector<std::pair<double,double>> dis(node_count, {0.0,0.0});
-    std::vector<std::vector<node_int>> adj_matrix = graph->get_adj_matrix();
 
-    // use doubles and uniform distribution
-    std::mt19937 rng((unsigned)std::time(nullptr));
-    std::uniform_real_distribution<double> rx(-fdl::WIDTH/2.0, fdl::WIDTH/2.0);
-    std::uniform_real_distribution<double> ry(-fdl::HEIGHT/2.0, fdl::HEIGHT/2.0);
+    const double area = (double)width * (double)height;
+    const double k = std::sqrt(area / (double)node_count); // NOTE: node_count not edge count
 
-    for(int i = 0; i < node_count; i++){
-        pos[i] = { rx(rng), ry(rng) }; // x,width ; y,height
+    // every layout of the same graph with the same seed starts (and therefore ends) the same
+    std::mt19937 rng(config_seed());
+    initial_placement placement = (initial_placement)fdl::INITIAL_PLACEMENT;
+    pos = place_nodes(graph, by_component ? RANDOM_PLACEMENT : placement, width, height, k, rng);
+
+    // a placed start is already close to the result, so it's only refined, with less movement
+    int max_iter = fdl::FDL_MAX_ITER;
+    double start_temp = fdl::FDL_START_TEMP;
+    if(placement != RANDOM_PLACEMENT){
+        max_iter = fdl::PLACED_MAX_ITER;
+        start_temp *= fdl::PLACED_START_TEMP_FACTOR;
     }
 
-    const double area = (double)fdl::WIDTH * (double)fdl::HEIGHT;
-    const double k = std::sqrt(area / (double)node_count); // NOTE: node_count not edge count
-
-    FDL *fdl = new FDL(pos, dis, adj_matrix, graph, fdl::WIDTH, fdl::HEIGHT, (int)area, fdl::FDL_MAX_ITER, k, fdl::FDL_START_TEMP);
+    FDL *fdl = new FDL(std::move(pos), std::move(dis), graph, width, height, (int)area, max_iter, k, start_temp);
     return fdl;
 }
 
-void fdl_to_json(std::string file_name, Graph* graph, FDL* fdl) {
-    std::string out_name = file_name.substr(0, file_name.size() - 4) + "-fdl.json";
-    DEBUG_PRINT("Creating JSON: " + out_name);
-
-    std::ofstream out;
-    out.open(out_name);
-    if (!out.is_open()) {
-        std::cerr << "[ERROR] could not open " << out_name << " for writing\n";
-        return;
-    }
-
-    std::vector<node_int> ranking;
-    if(fdl::INCLUDE_RANK_JSON){
-        ranking = rank_graph(graph, (ranking_algorithm)config::RANKING_ALGORITHM);
-    }
+/**
+ * @brief Returns the path of a JSON snapshot, e.g. 'data/data_set0-fdl.json' for snapshot 0 of 'data/data_set.txt'.
+ */
+std::string fdl_json_path(std::string file_name, int snapshot){
+    return file_name.substr(0, file_name.size() - 4) + std::to_string(snapshot) + "-fdl.json";
+}
 
+/**
+ * @brief Writes the JSON for the given positions to out, e.g. straight into its file.
+ *
+ * @param       ranking     The ranks of the nodes, only used if fdl::INCLUDE_RANK_JSON is set, left out if empty
+ * @param       clustering  The clustering coefficients of the nodes, only used if fdl::INCLUDE_CLUSTERING_JSON is set
+ */
+void fdl_json(std::ostream& out, Graph* graph, const std::vector<std::pair<double,double>>& pos, const std::vector<node_int>& ranking,
+              const std::vector<double>& clustering) {
     out << "{\n";
 
     // write nodes
     out << "  \"nodes\": [\n";
+    bool first = true;
     for (node_int v = 0; v < graph->get_vertex_nr(); v++) {
         // don't show if it's an isolated node
-        if(graph->get_adj_matrix()[v].empty() && !fdl::SHOW_ISOLATED_NODES_JSON){
+        if(graph->get_degree(v) == 0 && !fdl::SHOW_ISOLATED_NODES_JSON){
             continue;
         }
 
-        out << "    {\"id\": " << v
-            << ", \"x\": " << fdl->pos[v].first
-            << ", \"y\": " << fdl->pos[v].second
-            << ", \"label\": \"" << graph->get_communities()[v] << "\"";
+        // separators go in front, as the last vertex (in relabelled order) may be a hidden isolated one
+        if (!first) out << ",\n";
+        first = false;
+
+        out << "    {\"id\": " << graph->get_original_id(v)
+            << ", \"x\": " << pos[v].first
+            << ", \"y\": " << pos[v].second
+            << ", \"label\": \"" << graph->get_original_id(graph->get_communities()[v]) << "\"";
 
         if(fdl::INCLUDE_NEIGHBOURS_JSON){
-            node_int neighbour_number = graph->get_adj_matrix()[v].size();
+            edge_int neighbour_number = graph->get_degree(v);
             out << ", \"neighbours\": " << neighbour_number;
         }
-        if(fdl::INCLUDE_RANK_JSON){
+        if(fdl::INCLUDE_RANK_JSON && !ranking.empty()){
             out << ", \"rank\": " << ranking[v];
         }
+        if(fdl::INCLUDE_CLUSTERING_JSON){
+            out << ", \"clustering\": " << clustering[v];
+        }
 
         out << "}";
-        if (v < graph->get_vertex_nr() - 1) out << ",";
-        out << "\n";
     }
-    out << "  ],\n";
+    out << "\n  ],\n";
 
     // write edges
     out << "  \"edges\": [\n";
+    first = true;
     for (node_int e = 0; e < graph->get_vertex_nr(); e++) {
-        std::vector<node_int> neighbours = graph->get_adj_matrix()[e];
-        for (size_t i = 0; i < neighbours.size(); i++) {
-            out << "    {\"source\": " << e
-                << ", \"target\": " << neighbours[i] << "}";
-            if (!(e == graph->get_vertex_nr() - 1 && i == neighbours.size() - 1)) {
-                out << ",";
-            }
-            out << "\n";
-        }
+        graph->for_each_neighbor(e, [&](node_int target) {
+            if (!first) out << ",\n";
+            first = false;
+
+            out << "    {\"source\": " << graph->get_original_id(e)
+                << ", \"target\": " << graph->get_original_id(target) << "}";
+        });
     }
-    out << "  ]\n";
+    out << "\n  ]\n";
     out << "}\n";
+}
 
-    out.close();
+/**
+ * @brief Builds the JSON for the given positions in memory, so it can be handed to another thread for writing.
+ */
+std::string fdl_json(Graph* graph, const std::vector<std::pair<double,double>>& pos, const std::vector<node_int>& ranking,
+                     const std::vector<double>& clustering) {
+    std::ostringstream out;
+    fdl_json(out, graph, pos, ranking, clustering);
 
-    DEBUG_PRINT("Created JSON: " + out_name);
+    return out.str();
 }
 
 /**
- * @brief Interface function that calls all necessary functions in order to get the graph in the right shape.
+ * @brief Runs all iterations of the layout on an already started FDL.
+ *
+ * @param       recorder        If set, records the start positions and then every iteration (subject to its stride)
+ * @param       by_component    Hands the work to fdl_layout_components instead (see fdl::LAYOUT_BY_COMPONENT)
  */
-void fdl_run(std::string file_name, Graph* graph){
-    DEBUG_PRINT("FDL started");
+void fdl_layout(FDL* fdl, Graph* graph, FrameRecorder* recorder, bool by_component){
+    if(by_component){
+        fdl_layout_components(fdl, graph, recorder);
+        return;
+    }
 
-    FDL *fdl = fdl_start(graph);
+    if(recorder){
+        recorder->record(0, fdl->pos);
+    }
 
-    fdl_to_json(file_name.substr(0, file_name.size() - 4) + std::to_string(0) + file_name.substr(file_name.size() - 4, file_name.size()), graph, fdl);
-    for(int iteration = 1; iteration <= fdl::FDL_MAX_ITER; iteration++){
+    for(int iteration = 1; iteration <= fdl->max_iter; iteration++){
         //DEBUG_PRINT("FDL iteration: " + std::to_string(iteration));
-        print_progress_bar((double)iteration / fdl::FDL_MAX_ITER);
+        print_progress_bar((double)iteration / fdl->max_iter);
         fdl_iteration(fdl, graph, iteration);
-        //fdl_to_json(file_name.substr(0, file_name.size() - 4) + std::to_string(iteration) + file_name.substr(file_name.size() - 4, file_name.size()), graph, fdl);
-    }
-    std::cout << std::endl;
-    fdl_to_json(file_name.substr(0, file_name.size() - 4) + std::to_string(1) + file_name.substr(file_name.size() - 4, file_name.size()), graph, fdl);
-
 
-    DEBUG_PRINT("FDL exited");
-
-    return;
-}
\ No newline at end of file
+        if(recorder){
+            recorder->record(iteration, fdl->pos, iteration == fdl->max_iter);
+        }
+    }
+    if(SHOW_PROGRESS){
+        std::cout << std::endl;
+    }
+}
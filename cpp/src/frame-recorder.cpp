@@ -0,0 +1,226 @@
+/**
+ * @brief Implements the recording of the layout for animations. The stream uses the format:
+ *
+ *      [[Type (8 bits)]-[Version (8 bits)]-[Precision (8 bits)]-[Padding (8 bits)]-[Stride (32 bits)]-[Node count (64 bits)]] <- Header
+ *      [[Iteration (32 bits)]-[Kind (8 bits)]-[Padding (24 bits)]-[Scale (32 bits float)]-[X, Y per node]]* <- Frames
+ *
+ * Kind is the frame_precision of the frame (delta streams contain float32 key frames), the scale is only used by
+ * delta frames. The nodes are in the order of the ids of the input file.
+ */
+
+#include "frame-recorder.h"
+#include "main.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+/**
+ * @brief Converts to IEEE half precision, rounding to nearest.
+ */
+static uint16_t float_to_half(float value){
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+
+    uint16_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if(((bits >> 23) & 0xFF) == 0xFF){
+        return sign | 0x7C00 | (mantissa ? 0x200 : 0); // inf, nan
+    }
+    if(exponent >= 31){
+        return sign | 0x7C00; // too large, inf
+    }
+    if(exponent <= 0){
+        if(exponent < -10){
+            return sign; // too small, zero
+        }
+        // subnormal
+        mantissa |= 0x800000;
+        uint32_t shift = 14 - exponent;
+        uint16_t half = mantissa >> shift;
+        if((mantissa >> (shift - 1)) & 1){
+            half++;
+        }
+        return sign | half;
+    }
+
+    uint16_t half = sign | (exponent << 10) | (mantissa >> 13);
+    if(mantissa & 0x1000){
+        half++; // a carry into the exponent is still the correctly rounded value
+    }
+    return half;
+}
+
+FrameRecorder::FrameRecorder(std::string file_name, Graph* graph, frame_precision precision, int stride)
+    : graph(graph), precision(precision), stride(std::max(1, stride)){
+    // without a valid precision no frame could be encoded, so nothing is recorded at all (see record)
+    if(precision < FRAME_FLOAT32 || precision > FRAME_DELTA16){
+        std::cerr << "[ERROR] invalid frame precision " << (int)precision << ", not recording frames\n";
+        return;
+    }
+
+    std::string out_name = file_name.substr(0, file_name.size() - 4) + "-frames.bin";
+    DEBUG_PRINT("Recording frames to: " + out_name);
+
+    file.open(out_name, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "[ERROR] could not open " << out_name << " for writing\n";
+        return;
+    }
+
+    uint8_t header[16] = {0};
+    header[0] = 0x02; // type: frame stream
+    header[1] = 0x00; // version
+    header[2] = (uint8_t)precision;
+    uint32_t stride_block = this->stride;
+    uint64_t node_count = graph->get_vertex_nr();
+    memcpy(header + 4, &stride_block, sizeof(uint32_t));
+    memcpy(header + 8, &node_count, sizeof(uint64_t));
+    file.write((char*)header, sizeof(header));
+
+    front.resize(2 * node_count);
+    back.resize(2 * node_count);
+
+    worker = std::thread([this](){ this->work(); });
+}
+
+FrameRecorder::~FrameRecorder(){
+    this->close();
+}
+
+void FrameRecorder::record(int iteration, const std::vector<std::pair<double,double>>& pos, bool last){
+    // no writer, as the recorder failed to start
+    if(!worker.joinable() || (iteration % stride != 0 && !last)){
+        return;
+    }
+
+    // the writer holds the lock only to swap the buffers, never while writing
+    std::unique_lock<std::mutex> lock(mutex);
+    if(last){
+        // the final frame is worth waiting for, the layout is done anyway
+        idle.wait(lock, [this](){ return !pending; });
+    }
+    else if(pending){
+        // the writer is still busy with the previous frame
+        dropped_nr++;
+        return;
+    }
+
+    for(node_int v = 0; v < graph->get_vertex_nr(); v++){
+        node_int slot = graph->get_original_id(v);
+        back[2*slot]     = (float)pos[v].first;
+        back[2*slot + 1] = (float)pos[v].second;
+    }
+    back_iteration = iteration;
+    pending = true;
+    recorded_nr++;
+
+    lock.unlock();
+    wake.notify_one();
+}
+
+void FrameRecorder::close(){
+    if(!worker.joinable()){
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+
+    file.close();
+    DEBUG_PRINT("Recorded " + std::to_string(written_nr) + " frames, dropped " + std::to_string(dropped_nr));
+}
+
+int FrameRecorder::get_stride(){
+    return stride;
+}
+
+size_t FrameRecorder::get_recorded_nr(){
+    return recorded_nr;
+}
+
+size_t FrameRecorder::get_dropped_nr(){
+    return dropped_nr;
+}
+
+void FrameRecorder::work(){
+    while(true){
+        int iteration;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this](){ return stopping || pending; });
+
+            if(!pending){
+                return;
+            }
+
+            std::swap(front, back);
+            iteration = back_iteration;
+            pending = false;
+        }
+        idle.notify_all();
+
+        write_frame(iteration, front);
+    }
+}
+
+void FrameRecorder::write_frame(int iteration, const std::vector<float>& frame){
+    uint8_t kind = (uint8_t)precision;
+    float scale = 1.0f;
+
+    if(precision == FRAME_DELTA16 && written_nr % FRAME_KEY_INTERVAL == 0){
+        kind = FRAME_FLOAT32;
+    }
+
+    uint8_t frame_header[12] = {0};
+    uint32_t iteration_block = iteration;
+    memcpy(frame_header, &iteration_block, sizeof(uint32_t));
+    frame_header[4] = kind;
+
+    switch(kind){
+        case FRAME_FLOAT32:{
+            memcpy(frame_header + 8, &scale, sizeof(float));
+            file.write((char*)frame_header, sizeof(frame_header));
+            file.write((char*)frame.data(), frame.size() * sizeof(float));
+            reconstructed = frame;
+            break;
+        }
+        case FRAME_FLOAT16:{
+            std::vector<uint16_t> halves(frame.size());
+            for(size_t i = 0; i < frame.size(); i++){
+                halves[i] = float_to_half(frame[i]);
+            }
+            memcpy(frame_header + 8, &scale, sizeof(float));
+            file.write((char*)frame_header, sizeof(frame_header));
+            file.write((char*)halves.data(), halves.size() * sizeof(uint16_t));
+            break;
+        }
+        case FRAME_DELTA16:{
+            // deltas against what the reader reconstructs, not against the exact previous frame, so the error stays bounded
+            float max_delta = 0.0f;
+            for(size_t i = 0; i < frame.size(); i++){
+                max_delta = std::max(max_delta, std::fabs(frame[i] - reconstructed[i]));
+            }
+            scale = max_delta > 0.0f ? max_delta / 32767.0f : 1.0f;
+
+            std::vector<int16_t> deltas(frame.size());
+            for(size_t i = 0; i < frame.size(); i++){
+                long q = std::lround((frame[i] - reconstructed[i]) / scale);
+                deltas[i] = (int16_t)std::clamp(q, -32767L, 32767L);
+                reconstructed[i] += deltas[i] * scale;
+            }
+            memcpy(frame_header + 8, &scale, sizeof(float));
+            file.write((char*)frame_header, sizeof(frame_header));
+            file.write((char*)deltas.data(), deltas.size() * sizeof(int16_t));
+            break;
+        }
+    }
+
+    written_nr++;
+}
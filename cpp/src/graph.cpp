@@ -1,23 +1,30 @@
 #include <vector>
+#include <algorithm>
 #include "graph.h"
+#include "memory-budget.h"
 
 graph_type Graph::get_graph_type(){
-    return this->graph_type;
+    return this->type;
 }
 
 node_int Graph::get_vertex_nr(){
     return this->vertex_nr;
 }
 
-node_int Graph::get_edge_nr(){
+edge_int Graph::get_edge_nr(){
     return this->edge_nr;
 }
 
-std::vector<node_int>& Graph::get_degrees(){
+std::vector<edge_int> Graph::get_degrees(){
+    std::vector<edge_int> degrees(vertex_nr);
+    for(node_int v = 0; v < vertex_nr; v++){
+        degrees[v] = this->get_degree(v);
+    }
+
     return degrees;
 }
 
-std::vector<node_int>& Graph::get_offsets(){
+std::vector<edge_int>& Graph::get_offsets(){
     return offsets;
 }
 
@@ -30,27 +37,160 @@ std::vector<node_int>& Graph::get_communities(){
 }
 
 std::vector<node_int> Graph::get_neighbors(node_int id){
-    auto& offsets = this->get_offsets();
-    auto& targets = this->get_targets();
-    //auto& communities = this->get_communities();
+    if (this->get_degree(id) == 0) return {}; // isolated node, nothing to do
 
-    node_int begin_index = offsets[id];
-    node_int end_index   = offsets[id + 1];
+    std::vector<node_int> neighbors;
+    neighbors.reserve(this->get_degree(id));
+    this->for_each_neighbor(id, [&neighbors](node_int u){
+        neighbors.push_back(u);
+    });
 
-    if (begin_index == end_index) return {}; // isolated node, nothing to do
+    return neighbors;
+}
 
-    // copy neighbors to temp vector for sorting
-    std::vector<node_int> neighbors(targets.begin() + begin_index, targets.begin() + end_index);
+edge_int Graph::get_degree(node_int id){
+    if(compressed){
+        return adjacency.get_degree(id);
+    }
+    return offsets[id + 1] - offsets[id];
+}
 
-    return neighbors;
+Graph::~Graph(){
+    memory_track(MEMORY_GRAPH, -tracked_bytes);
 }
 
-std::vector<std::vector<node_int>> Graph::get_adj_matrix(){
-    std::vector<std::vector<node_int>> adj_matrix;
+void Graph::track_memory(){
+    int64_t bytes = offsets.capacity() * sizeof(edge_int)
+                  + (targets.capacity() + communities.capacity()) * sizeof(node_int)
+                  + (permutation.capacity() + original_ids.capacity()) * sizeof(node_int);
+    if(compressed){
+        bytes += adjacency.size_in_bytes();
+    }
+
+    memory_track(MEMORY_GRAPH, bytes - tracked_bytes);
+    tracked_bytes = bytes;
+}
+
+void Graph::relabel(const std::vector<node_int>& perm){
+    const node_int n = this->get_vertex_nr();
 
-    for(node_int i = 0; i < this->get_vertex_nr(); i++){
-        adj_matrix.push_back(this->get_neighbors(i));
+    std::vector<node_int> inverse(n);
+    for(node_int v = 0; v < n; v++){
+        inverse[perm[v]] = v;
     }
 
-    return adj_matrix;
+    std::vector<edge_int> new_offsets(n + 1, 0);
+    std::vector<node_int> new_targets(edge_nr);
+    std::vector<node_int> new_communities(n);
+
+    for(node_int u = 0; u < n; u++){
+        node_int old = inverse[u];
+
+        new_offsets[u + 1] = new_offsets[u] + this->get_degree(old);
+        edge_int write_index = new_offsets[u];
+        this->for_each_neighbor(old, [&](node_int t){
+            new_targets[write_index++] = perm[t];
+        });
+        std::sort(new_targets.begin() + new_offsets[u], new_targets.begin() + new_offsets[u + 1]);
+
+        // community labels are vertex ids as well, so they follow the relabelling
+        new_communities[u] = perm[communities[old]];
+    }
+
+    offsets = std::move(new_offsets);
+    targets = std::move(new_targets);
+    communities = std::move(new_communities);
+
+    if(compressed){
+        adjacency = compress_adjacency(offsets, targets);
+        this->free_csr();
+    }
+
+    // compose with an earlier relabelling, if any
+    if(original_ids.empty()){
+        original_ids = inverse;
+    }
+    else{
+        for(node_int u = 0; u < n; u++){
+            inverse[u] = original_ids[inverse[u]];
+        }
+        original_ids = inverse;
+    }
+
+    permutation.assign(n, 0);
+    for(node_int u = 0; u < n; u++){
+        permutation[original_ids[u]] = u;
+    }
+
+    this->track_memory();
+}
+
+node_int Graph::get_original_id(node_int id){
+    if(original_ids.empty()){
+        return id;
+    }
+    return original_ids[id];
+}
+
+node_int Graph::get_internal_id(node_int original_id){
+    if(permutation.empty()){
+        return original_id;
+    }
+    return permutation[original_id];
+}
+
+bool Graph::is_relabelled(){
+    return !original_ids.empty();
+}
+
+std::vector<node_int>& Graph::get_original_ids(){
+    return original_ids;
+}
+
+void Graph::set_original_ids(std::vector<node_int> original_ids){
+    this->original_ids = std::move(original_ids);
+
+    permutation.assign(this->original_ids.size(), 0);
+    for(size_t u = 0; u < this->original_ids.size(); u++){
+        permutation[this->original_ids[u]] = (node_int)u;
+    }
+
+    this->track_memory();
+}
+
+void Graph::compress(){
+    if(compressed){
+        return;
+    }
+
+    adjacency = compress_adjacency(offsets, targets);
+    compressed = true;
+    // both forms exist for a moment, which is the peak of the compression
+    this->track_memory();
+
+    this->free_csr();
+    this->track_memory();
+}
+
+void Graph::set_compressed_adjacency(CompressedAdjacency adjacency){
+    this->adjacency = std::move(adjacency);
+    compressed = true;
+
+    this->free_csr();
+    this->track_memory();
+}
+
+void Graph::free_csr(){
+    offsets.clear();
+    offsets.shrink_to_fit();
+    targets.clear();
+    targets.shrink_to_fit();
+}
+
+bool Graph::is_compressed(){
+    return compressed;
+}
+
+CompressedAdjacency& Graph::get_compressed_adjacency(){
+    return adjacency;
 }
\ No newline at end of file
@@ -0,0 +1,308 @@
+/**
+ * @brief Implements the start positions of the layout. A start close to the final layout lets the FDL run far fewer
+ * (and cooler) iterations than it needs to untangle a random one.
+ */
+
+#include "initial-placement.h"
+#include "thread-pool.h"
+#include "config.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+// Below this many nodes the BFS runs are not worth a thread pool (many components are this small).
+static const node_int PARALLEL_BFS_MIN_NODES = 2048;
+
+std::vector<uint32_t> bfs_distances(Graph* graph, node_int source){
+    const node_int n = graph->get_vertex_nr();
+    const uint32_t unreached = std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint32_t> distances(n, unreached);
+    std::vector<node_int> queue;
+    queue.reserve(n);
+
+    distances[source] = 0;
+    queue.push_back(source);
+    for(size_t head = 0; head < queue.size(); head++){
+        node_int v = queue[head];
+        graph->for_each_neighbor(v, [&](node_int u){
+            if(distances[u] == unreached){
+                distances[u] = distances[v] + 1;
+                queue.push_back(u);
+            }
+        });
+    }
+
+    // unreachable vertices (other components) are put just beyond the farthest one
+    const uint32_t max_distance = distances[queue.back()];
+    for(uint32_t& d : distances){
+        if(d == unreached){
+            d = max_distance + 1;
+        }
+    }
+
+    return distances;
+}
+
+static std::vector<std::pair<double,double>> random_placement(node_int n, double width, double height, std::mt19937& rng){
+    std::uniform_real_distribution<double> rx(-width/2.0, width/2.0);
+    std::uniform_real_distribution<double> ry(-height/2.0, height/2.0);
+
+    std::vector<std::pair<double,double>> pos(n);
+    for(node_int i = 0; i < n; i++){
+        pos[i] = { rx(rng), ry(rng) }; // x,width ; y,height
+    }
+
+    return pos;
+}
+
+/**
+ * @brief Power iteration for the dominant eigenvector of the symmetric k x k matrix m, orthogonal to skip (if given).
+ */
+static std::vector<double> dominant_eigenvector(const std::vector<double>& m, size_t k, const std::vector<double>* skip, std::mt19937& rng){
+    std::uniform_real_distribution<double> start(-1.0, 1.0);
+    std::vector<double> v(k);
+    for(double& x : v){
+        x = start(rng);
+    }
+
+    std::vector<double> next(k);
+    for(int iteration = 0; iteration < 100; iteration++){
+        if(skip){
+            double dot = 0.0;
+            for(size_t i = 0; i < k; i++){
+                dot += v[i] * (*skip)[i];
+            }
+            for(size_t i = 0; i < k; i++){
+                v[i] -= dot * (*skip)[i];
+            }
+        }
+
+        double norm = 0.0;
+        for(size_t i = 0; i < k; i++){
+            next[i] = 0.0;
+            for(size_t j = 0; j < k; j++){
+                next[i] += m[i*k + j] * v[j];
+            }
+            norm += next[i] * next[i];
+        }
+        norm = std::sqrt(norm);
+        if(norm < 1e-12){
+            break;
+        }
+
+        double change = 0.0;
+        for(size_t i = 0; i < k; i++){
+            next[i] /= norm;
+            change += std::abs(next[i] - v[i]);
+        }
+        v.swap(next);
+        if(change < 1e-9){
+            break;
+        }
+    }
+
+    return v;
+}
+
+/**
+ * @brief Pivot MDS. The pivots are picked max-min (each one as far as possible from those already picked) in rounds
+ * of one pivot per thread, whose BFS runs in parallel.
+ */
+static std::vector<std::pair<double,double>> pivot_mds(Graph* graph, std::mt19937& rng){
+    const node_int n = graph->get_vertex_nr();
+    const size_t pivot_nr = std::min<size_t>(std::max(fdl::PIVOT_NR, 2), n);
+
+    std::unique_ptr<ThreadPool> own_pool;
+    ThreadPool* pool = nullptr;
+    size_t round_size = 1;
+    if(n >= PARALLEL_BFS_MIN_NODES){
+        pool = current_or_own_pool(own_pool, config::PIPELINE_THREADS);
+        round_size = pool->get_thread_nr();
+    }
+
+    std::vector<node_int> pivots;
+    std::vector<std::vector<uint32_t>> distances;
+    std::vector<uint32_t> min_distance(n, std::numeric_limits<uint32_t>::max());
+    std::vector<bool> is_pivot(n, false);
+
+    // the first round starts from a random vertex, later ones from the vertices farthest from all pivots so far
+    std::vector<node_int> candidates(n);
+    for(node_int v = 0; v < n; v++){
+        candidates[v] = v;
+    }
+    std::shuffle(candidates.begin(), candidates.end(), rng);
+
+    while(pivots.size() < pivot_nr){
+        size_t round = std::min(round_size, pivot_nr - pivots.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + round, candidates.end(), [&](node_int a, node_int b) -> bool{
+            if(is_pivot[a] != is_pivot[b]){
+                return is_pivot[b];
+            }
+            return min_distance[a] > min_distance[b];
+        });
+
+        std::vector<node_int> round_pivots(candidates.begin(), candidates.begin() + round);
+        std::vector<std::vector<uint32_t>> round_distances(round);
+        if(pool){
+            std::vector<std::future<void>> done;
+            for(size_t i = 0; i < round; i++){
+                done.push_back(pool->submit([graph, &round_pivots, &round_distances, i](){
+                    round_distances[i] = bfs_distances(graph, round_pivots[i]);
+                }));
+            }
+            for(std::future<void>& f : done){
+                pool->wait(f);
+            }
+        }
+        else{
+            for(size_t i = 0; i < round; i++){
+                round_distances[i] = bfs_distances(graph, round_pivots[i]);
+            }
+        }
+
+        for(size_t i = 0; i < round; i++){
+            is_pivot[round_pivots[i]] = true;
+            for(node_int v = 0; v < n; v++){
+                min_distance[v] = std::min(min_distance[v], round_distances[i][v]);
+            }
+            pivots.push_back(round_pivots[i]);
+            distances.push_back(std::move(round_distances[i]));
+        }
+    }
+
+    // double centring of the squared distances: c_vj = -1/2 (d_vj^2 - mean of column j - mean of row v + mean of all)
+    const size_t k = pivots.size();
+    std::vector<double> column_mean(k, 0.0);
+    std::vector<double> row_mean(n, 0.0);
+    double total_mean = 0.0;
+    for(size_t j = 0; j < k; j++){
+        for(node_int v = 0; v < n; v++){
+            double d2 = (double)distances[j][v] * distances[j][v];
+            column_mean[j] += d2;
+            row_mean[v] += d2;
+        }
+        total_mean += column_mean[j];
+        column_mean[j] /= n;
+    }
+    for(node_int v = 0; v < n; v++){
+        row_mean[v] /= k;
+    }
+    total_mean /= (double)n * k;
+
+    std::vector<double> c((size_t)n * k);
+    for(node_int v = 0; v < n; v++){
+        for(size_t j = 0; j < k; j++){
+            double d2 = (double)distances[j][v] * distances[j][v];
+            c[(size_t)v*k + j] = -0.5 * (d2 - column_mean[j] - row_mean[v] + total_mean);
+        }
+    }
+
+    // the two main axes are the dominant eigenvectors of C^T C (k x k)
+    std::vector<double> ctc(k * k, 0.0);
+    for(node_int v = 0; v < n; v++){
+        for(size_t i = 0; i < k; i++){
+            for(size_t j = 0; j < k; j++){
+                ctc[i*k + j] += c[(size_t)v*k + i] * c[(size_t)v*k + j];
+            }
+        }
+    }
+    std::vector<double> axis_x = dominant_eigenvector(ctc, k, nullptr, rng);
+    std::vector<double> axis_y = dominant_eigenvector(ctc, k, &axis_x, rng);
+
+    std::vector<std::pair<double,double>> pos(n, {0.0, 0.0});
+    for(node_int v = 0; v < n; v++){
+        for(size_t j = 0; j < k; j++){
+            pos[v].first  += c[(size_t)v*k + j] * axis_x[j];
+            pos[v].second += c[(size_t)v*k + j] * axis_y[j];
+        }
+    }
+
+    // vertices at the same distance from all pivots end up on top of each other, a tiny jitter lets the FDL separate them
+    std::uniform_real_distribution<double> jitter(-1e-3, 1e-3);
+    for(std::pair<double,double>& p : pos){
+        p.first  += jitter(rng);
+        p.second += jitter(rng);
+    }
+
+    return pos;
+}
+
+/**
+ * @brief Community discs on a spiral, largest community in the middle. The area of a disc grows with its size.
+ */
+static std::vector<std::pair<double,double>> community_placement(Graph* graph, std::mt19937& rng){
+    const node_int n = graph->get_vertex_nr();
+    auto& communities = graph->get_communities();
+
+    std::unordered_map<node_int, size_t> sizes;
+    for(node_int v = 0; v < n; v++){
+        sizes[communities[v]]++;
+    }
+
+    std::vector<std::pair<size_t, node_int>> order;
+    for(const auto& entry : sizes){
+        order.push_back({entry.second, entry.first});
+    }
+    std::sort(order.begin(), order.end(), std::greater<std::pair<size_t, node_int>>());
+
+    // Vogel's spiral: disc i sits at radius ~ sqrt(nodes placed so far), so the discs fill a circle evenly
+    const double golden_angle = M_PI * (3.0 - std::sqrt(5.0));
+    std::unordered_map<node_int, std::pair<double,double>> centres;
+    std::unordered_map<node_int, double> radii;
+    size_t placed = 0;
+    for(size_t i = 0; i < order.size(); i++){
+        double radius = i == 0 ? 0.0 : std::sqrt((double)placed + order[i].first / 2.0);
+        centres[order[i].second] = {radius * std::cos(i * golden_angle), radius * std::sin(i * golden_angle)};
+        radii[order[i].second] = std::sqrt((double)order[i].first) / 2.0;
+        placed += order[i].first;
+    }
+
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<std::pair<double,double>> pos(n);
+    for(node_int v = 0; v < n; v++){
+        double r = radii[communities[v]] * std::sqrt(unit(rng));
+        double angle = 2.0 * M_PI * unit(rng);
+        const std::pair<double,double>& centre = centres[communities[v]];
+        pos[v] = {centre.first + r * std::cos(angle), centre.second + r * std::sin(angle)};
+    }
+
+    return pos;
+}
+
+std::vector<std::pair<double,double>> place_nodes(Graph* graph, initial_placement placement, double width, double height,
+                                                  double k, std::mt19937& rng){
+    const node_int n = graph->get_vertex_nr();
+    if(placement == RANDOM_PLACEMENT || n < 3){
+        return random_placement(n, width, height, rng);
+    }
+
+    std::vector<std::pair<double,double>> pos = placement == PIVOT_MDS ? pivot_mds(graph, rng)
+                                                                       : community_placement(graph, rng);
+
+    // centre, then scale so that the mean edge length is the ideal one
+    double cx = 0.0, cy = 0.0;
+    for(const std::pair<double,double>& p : pos){
+        cx += p.first;
+        cy += p.second;
+    }
+    cx /= n;
+    cy /= n;
+
+    double length_sum = 0.0;
+    edge_int length_nr = 0;
+    for(node_int v = 0; v < n; v++){
+        graph->for_each_neighbor(v, [&](node_int u){
+            length_sum += std::hypot(pos[v].first - pos[u].first, pos[v].second - pos[u].second);
+            length_nr++;
+        });
+    }
+    const double scale = length_nr > 0 && length_sum > 1e-12 ? k * length_nr / length_sum : 1.0;
+
+    for(std::pair<double,double>& p : pos){
+        p = {(p.first - cx) * scale, (p.second - cy) * scale};
+    }
+
+    return pos;
+}
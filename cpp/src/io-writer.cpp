@@ -0,0 +1,91 @@
+#include "io-writer.h"
+#include "main.h"
+#include "memory-budget.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+IOWriter::IOWriter(){
+    worker = std::thread([this](){ this->work(); });
+}
+
+/**
+ * @brief Finishes all queued jobs, then joins the writer thread.
+ */
+IOWriter::~IOWriter(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    worker.join();
+}
+
+std::future<void> IOWriter::submit(std::function<void()> job){
+    // std::function has to be copyable, hence the shared_ptr around the task
+    auto task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+    std::future<void> done = task->get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push([task](){ (*task)(); });
+    }
+    wake.notify_one();
+
+    return done;
+}
+
+std::future<void> IOWriter::write(std::string path, std::string data){
+    // std::function has to be copyable, hence the shared_ptr around the buffer
+    auto buffer = std::make_shared<std::string>(std::move(data));
+    memory_track(MEMORY_QUEUED_WRITES, buffer->capacity());
+
+    return this->submit([path, buffer](){
+        DEBUG_PRINT("Writing: " + path);
+
+        std::ofstream out(path, std::ios::binary);
+        if(!out.is_open()){
+            std::cerr << "[ERROR] could not open " << path << " for writing\n";
+        }
+        else{
+            out.write(buffer->data(), buffer->size());
+            out.close();
+            DEBUG_PRINT("Written: " + path);
+        }
+
+        memory_track(MEMORY_QUEUED_WRITES, -(int64_t)buffer->capacity());
+        buffer->clear();
+        buffer->shrink_to_fit();
+    });
+}
+
+void IOWriter::wait(){
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this](){ return jobs.empty() && !busy; });
+}
+
+void IOWriter::work(){
+    while(true){
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this](){ return stopping || !jobs.empty(); });
+
+            if(jobs.empty()){
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop();
+            busy = true;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busy = false;
+        }
+        idle.notify_all();
+    }
+}
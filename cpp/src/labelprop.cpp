@@ -6,23 +6,22 @@
 #include "labelprop.h"
 #include "graph.h"
 #include "config.h"
+#include "kernel-dispatch.h"
 #include <vector>
 #include <algorithm>
 #include <iostream>
 
 
-void propagate(Graph* graph, node_int node_index) {
-    auto& offsets = graph->get_offsets();
-    auto& targets = graph->get_targets();
+template<bool COMPRESSED> void propagate(Graph* graph, node_int node_index, std::vector<node_int>& neighbors, std::mt19937& rng) {
     auto& communities = graph->get_communities();
 
-    node_int begin_index = offsets[node_index];
-    node_int end_index   = offsets[node_index + 1];
-
-    if (begin_index == end_index) return; // isolated node, nothing to do
+    if (graph->get_degree(node_index) == 0) return; // isolated node, nothing to do
 
     // copy neighbors to temp vector for sorting
-    std::vector<node_int> neighbors(targets.begin() + begin_index, targets.begin() + end_index);
+    neighbors.clear();
+    graph->template for_each_neighbor_as<COMPRESSED>(node_index, [&neighbors](node_int u) {
+        neighbors.push_back(u);
+    });
     std::sort(neighbors.begin(), neighbors.end());
 
     node_int max_count = 1;
@@ -48,20 +47,24 @@ void propagate(Graph* graph, node_int node_index) {
     if (final_elements.size() == 1) {
         communities[node_index] = final_elements.back();
     } else if (!final_elements.empty()) {
-        communities[node_index] = final_elements[std::rand() % final_elements.size()];
+        communities[node_index] = final_elements[rng() % final_elements.size()];
     }
 }
 
 
-int label_prop(Graph* graph){
+int label_prop(Graph* graph, std::mt19937& rng){
     node_int vertex_nr = graph->get_vertex_nr();
     //node_int edge_nr = graph->get_edge_nr();
 
-    for(node_int r = 0; r < config::PROP_STEPS_PER_ITER; r++){
-        for(node_int i = 0; i < vertex_nr; i++){
-            propagate(graph, i);
+    // the buffer is reused for all vertices, the representation is fixed once per call
+    std::vector<node_int> neighbors;
+    dispatch_flag(graph->is_compressed(), [&](auto compressed){
+        for(node_int r = 0; r < config::PROP_STEPS_PER_ITER; r++){
+            for(node_int i = 0; i < vertex_nr; i++){
+                propagate<decltype(compressed)::value>(graph, i, neighbors, rng);
+            }
         }
-    }
+    });
 
     return 1;
 }
\ No newline at end of file
@@ -0,0 +1,415 @@
+/**
+ * @brief Implements the layout quality metrics and the 'evaluate' command, which weighs the time of the layout
+ * settings against the quality of their results.
+ *
+ * Every metric is sampled so that measuring stays cheap next to the layout itself: stress needs one BFS per source,
+ * neighbourhood preservation one k-nearest query per vertex, and the crossings only test the edges sharing a cell of
+ * a uniform grid with the sampled ones.
+ */
+
+#include "layout-quality.h"
+#include "force-directed-layout.h"
+#include "initial-placement.h"
+#include "spatial-index.h"
+#include "components.h"
+#include "preproc.h"
+#include "config.h"
+#include "config-loader.h"
+#include "main.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+
+typedef std::pair<double,double> point;
+
+/**
+ * @brief Every edge once (u < v), without loops and duplicates.
+ */
+static std::vector<std::pair<node_int, node_int>> unique_edges(Graph* graph){
+    std::vector<std::pair<node_int, node_int>> edges;
+    for(size_t u = 0; u < graph->get_vertex_nr(); u++){
+        graph->for_each_neighbor((node_int)u, [&edges, u](node_int v){
+            if(u < v){
+                edges.push_back({(node_int)u, v});
+            }
+        });
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    return edges;
+}
+
+/**
+ * @brief count distinct items of items, or all of them if there are fewer.
+ */
+static std::vector<node_int> sample(const std::vector<node_int>& items, size_t count, std::mt19937& rng){
+    if(items.size() <= count){
+        return items;
+    }
+
+    std::vector<node_int> result;
+    std::sample(items.begin(), items.end(), std::back_inserter(result), count, rng);
+    return result;
+}
+
+static inline double distance(const point& a, const point& b){
+    return std::sqrt((a.first - b.first) * (a.first - b.first) + (a.second - b.second) * (a.second - b.second));
+}
+
+/**
+ * @brief With x = distance / hops for every pair, the stress sum((s*x - 1)^2) is minimal for s = sum(x) / sum(x^2),
+ * where it is count - sum(x)^2 / sum(x^2). Only pairs in the same component count, components are placed
+ * independently of each other.
+ */
+static double sampled_stress(Graph* graph, const std::vector<point>& pos, const std::vector<node_int>& sources){
+    std::vector<node_int> labels = connected_components(graph, config::PIPELINE_THREADS);
+
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    double count = 0.0;
+    for(node_int s : sources){
+        std::vector<uint32_t> hops = bfs_distances(graph, s);
+        for(size_t v = 0; v < hops.size(); v++){
+            if(v == s || labels[v] != labels[s]){
+                continue;
+            }
+
+            double x = distance(pos[s], pos[v]) / hops[v];
+            sum += x;
+            sum_squares += x * x;
+            count++;
+        }
+    }
+
+    if(count == 0 || sum_squares == 0){
+        return 0.0;
+    }
+    return (count - sum * sum / sum_squares) / count;
+}
+
+static double edge_length_cv(const std::vector<point>& pos, const std::vector<std::pair<node_int, node_int>>& edges){
+    if(edges.empty()){
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    for(const auto& [u, v] : edges){
+        double length = distance(pos[u], pos[v]);
+        sum += length;
+        sum_squares += length * length;
+    }
+
+    double mean = sum / edges.size();
+    double variance = std::max(0.0, sum_squares / edges.size() - mean * mean);
+    return mean > 0 ? std::sqrt(variance) / mean : 0.0;
+}
+
+/**
+ * @brief Compares, per sampled vertex, its neighbours with its deg(v) nearest vertices in the layout. The spatial
+ * index works on the ids of the input file, so the neighbours are compared in those.
+ */
+static double neighbourhood_preservation(Graph* graph, const std::vector<point>& pos, const std::vector<node_int>& vertices){
+    if(vertices.empty()){
+        return 0.0;
+    }
+
+    SpatialIndex* index = spatial_index_build(pos, graph);
+
+    double sum = 0.0;
+    std::vector<node_int> neighbours;
+    for(node_int v : vertices){
+        node_int id = graph->get_original_id(v);
+
+        neighbours.clear();
+        graph->for_each_neighbor(v, [&neighbours, graph, id](node_int u){
+            node_int original = graph->get_original_id(u);
+            if(original != id){
+                neighbours.push_back(original);
+            }
+        });
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+        // the vertex itself is (usually) the nearest one, so one more is asked for and it is dropped
+        std::vector<node_int> nearest = index->query_nearest(pos[v].first, pos[v].second, neighbours.size() + 1);
+        auto self = std::find(nearest.begin(), nearest.end(), id);
+        if(self != nearest.end()){
+            nearest.erase(self);
+        }
+        nearest.resize(std::min(nearest.size(), neighbours.size()));
+        std::sort(nearest.begin(), nearest.end());
+
+        std::vector<node_int> shared;
+        std::set_intersection(neighbours.begin(), neighbours.end(), nearest.begin(), nearest.end(), std::back_inserter(shared));
+        double united = neighbours.size() + nearest.size() - shared.size();
+        sum += united > 0 ? shared.size() / united : 1.0;
+    }
+
+    delete index;
+    return sum / vertices.size();
+}
+
+/**
+ * @brief A uniform grid over the bounding box of the layout, holding for every cell the edges passing through it.
+ */
+struct crossing_grid{
+    double min_x;
+    double min_y;
+    double cell_width;
+    double cell_height;
+    long side;
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> edges;
+};
+
+static inline long grid_cell(double value, double min, double cell_size, long side){
+    return std::clamp((long)std::floor((value - min) / cell_size), 0l, side - 1);
+}
+
+/**
+ * @brief Calls f(cell) for every cell the segment a-b passes through (see: Amanatides and Woo, "A Fast Voxel
+ * Traversal Algorithm for Ray Tracing"). Always ends in the cell of b, even where rounding disagrees.
+ */
+template<typename F> static void for_each_cell(const crossing_grid& grid, const point& a, const point& b, F f){
+    long x = grid_cell(a.first, grid.min_x, grid.cell_width, grid.side);
+    long y = grid_cell(a.second, grid.min_y, grid.cell_height, grid.side);
+    const long end_x = grid_cell(b.first, grid.min_x, grid.cell_width, grid.side);
+    const long end_y = grid_cell(b.second, grid.min_y, grid.cell_height, grid.side);
+
+    const double dx = b.first - a.first;
+    const double dy = b.second - a.second;
+    const long step_x = dx > 0 ? 1 : -1;
+    const long step_y = dy > 0 ? 1 : -1;
+    const double infinity = std::numeric_limits<double>::infinity();
+    double t_max_x = dx != 0 ? (grid.min_x + (x + (step_x > 0)) * grid.cell_width - a.first) / dx : infinity;
+    double t_max_y = dy != 0 ? (grid.min_y + (y + (step_y > 0)) * grid.cell_height - a.second) / dy : infinity;
+    const double t_delta_x = dx != 0 ? grid.cell_width / std::abs(dx) : infinity;
+    const double t_delta_y = dy != 0 ? grid.cell_height / std::abs(dy) : infinity;
+
+    f((size_t)(y * grid.side + x));
+    while(x != end_x || y != end_y){
+        if(y == end_y || (x != end_x && t_max_x < t_max_y)){
+            x += step_x;
+            t_max_x += t_delta_x;
+        }
+        else{
+            y += step_y;
+            t_max_y += t_delta_y;
+        }
+        f((size_t)(y * grid.side + x));
+    }
+}
+
+static inline double orientation(const point& a, const point& b, const point& c){
+    return (b.first - a.first) * (c.second - a.second) - (b.second - a.second) * (c.first - a.first);
+}
+
+/**
+ * @brief Whether a-b and c-d properly cross, touching and collinear overlaps don't count.
+ */
+static inline bool segments_cross(const point& a, const point& b, const point& c, const point& d){
+    double o1 = orientation(a, b, c);
+    double o2 = orientation(a, b, d);
+    double o3 = orientation(c, d, a);
+    double o4 = orientation(c, d, b);
+    return ((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) && ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0));
+}
+
+/**
+ * @brief The mean number of edges crossing the sampled edges. Edges sharing an endpoint never cross.
+ */
+static double sampled_crossings(const std::vector<point>& pos, const std::vector<std::pair<node_int, node_int>>& edges,
+                                const std::vector<size_t>& sampled){
+    if(sampled.empty()){
+        return 0.0;
+    }
+
+    crossing_grid grid;
+    double max_x = -std::numeric_limits<double>::infinity();
+    double max_y = -std::numeric_limits<double>::infinity();
+    grid.min_x = std::numeric_limits<double>::infinity();
+    grid.min_y = std::numeric_limits<double>::infinity();
+    for(const auto& [u, v] : edges){
+        for(node_int w : {u, v}){
+            grid.min_x = std::min(grid.min_x, pos[w].first);
+            grid.min_y = std::min(grid.min_y, pos[w].second);
+            max_x = std::max(max_x, pos[w].first);
+            max_y = std::max(max_y, pos[w].second);
+        }
+    }
+
+    // about one edge per cell, most edges then only touch a handful of cells
+    grid.side = std::clamp((long)std::sqrt((double)edges.size()), 1l, 1024l);
+    grid.cell_width = max_x > grid.min_x ? (max_x - grid.min_x) / grid.side : 1.0;
+    grid.cell_height = max_y > grid.min_y ? (max_y - grid.min_y) / grid.side : 1.0;
+
+    // counting sort of the (cell, edge) pairs into a CSR
+    grid.offsets.assign(grid.side * grid.side + 1, 0);
+    for(const auto& [u, v] : edges){
+        for_each_cell(grid, pos[u], pos[v], [&grid](size_t cell){
+            grid.offsets[cell + 1]++;
+        });
+    }
+    for(size_t cell = 0; cell + 1 < grid.offsets.size(); cell++){
+        grid.offsets[cell + 1] += grid.offsets[cell];
+    }
+    grid.edges.resize(grid.offsets.back());
+    std::vector<size_t> fill(grid.offsets.begin(), grid.offsets.end() - 1);
+    for(size_t e = 0; e < edges.size(); e++){
+        for_each_cell(grid, pos[edges[e].first], pos[edges[e].second], [&grid, &fill, e](size_t cell){
+            grid.edges[fill[cell]++] = (uint32_t)e;
+        });
+    }
+
+    // an edge spanning several cells meets the same candidates more than once, they are only tested once
+    std::vector<uint32_t> tested(edges.size(), std::numeric_limits<uint32_t>::max());
+    uint64_t crossings = 0;
+    for(size_t i = 0; i < sampled.size(); i++){
+        const auto& [a, b] = edges[sampled[i]];
+        for_each_cell(grid, pos[a], pos[b], [&](size_t cell){
+            for(size_t j = grid.offsets[cell]; j < grid.offsets[cell + 1]; j++){
+                uint32_t e = grid.edges[j];
+                if(tested[e] == i){
+                    continue;
+                }
+                tested[e] = (uint32_t)i;
+
+                const auto& [c, d] = edges[e];
+                if(a == c || a == d || b == c || b == d){
+                    continue;
+                }
+                crossings += segments_cross(pos[a], pos[b], pos[c], pos[d]);
+            }
+        });
+    }
+
+    return (double)crossings / sampled.size();
+}
+
+layout_quality measure_layout(Graph* graph, const std::vector<std::pair<double,double>>& pos, unsigned seed){
+    std::mt19937 rng(seed);
+    std::vector<std::pair<node_int, node_int>> edges = unique_edges(graph);
+
+    // only vertices with an edge are measured, isolated ones are not drawn
+    std::vector<bool> has_edge(graph->get_vertex_nr(), false);
+    for(const auto& [u, v] : edges){
+        has_edge[u] = true;
+        has_edge[v] = true;
+    }
+    std::vector<node_int> drawn;
+    for(size_t v = 0; v < has_edge.size(); v++){
+        if(has_edge[v]){
+            drawn.push_back((node_int)v);
+        }
+    }
+
+    // the sampled edges are drawn with replacement, so that large graphs don't need a list of all indices
+    std::vector<size_t> sampled_edges;
+    if(edges.size() <= (size_t)fdl::EVALUATE_SAMPLES){
+        for(size_t e = 0; e < edges.size(); e++){
+            sampled_edges.push_back(e);
+        }
+    }
+    else{
+        std::uniform_int_distribution<size_t> edge_dist(0, edges.size() - 1);
+        for(int i = 0; i < fdl::EVALUATE_SAMPLES; i++){
+            sampled_edges.push_back(edge_dist(rng));
+        }
+    }
+
+    layout_quality quality;
+    quality.stress = sampled_stress(graph, pos, sample(drawn, fdl::EVALUATE_SOURCES, rng));
+    quality.edge_length_cv = edge_length_cv(pos, edges);
+    quality.neighbourhood_preservation = neighbourhood_preservation(graph, pos, sample(drawn, fdl::EVALUATE_SAMPLES, rng));
+    quality.crossings_per_edge = sampled_crossings(pos, edges, sampled_edges);
+
+    return quality;
+}
+
+int evaluate_layouts(std::string file_name){
+    Graph* graph = txt_to_graph(file_name);
+    if(!graph){
+        return 0;
+    }
+    if(graph->get_vertex_nr() == 0){
+        std::cerr << "layout-quality.cpp: " << file_name << " has no edges" << std::endl;
+        delete graph;
+        return 0;
+    }
+    prepare_graph(graph);
+    find_communities(graph);
+    finish_graph(graph);
+
+    // the values varied below are put back at the end
+    const int default_placement = fdl::INITIAL_PLACEMENT;
+    const bool default_by_component = fdl::LAYOUT_BY_COMPONENT;
+    const int default_max_iter = fdl::FDL_MAX_ITER;
+    const int default_placed_max_iter = fdl::PLACED_MAX_ITER;
+    const unsigned default_seed = config::SEED;
+
+    // every layout is measured on the same samples, only the layouts themselves get different seeds
+    const unsigned seed = config_seed();
+    const int seed_nr = std::max(1, fdl::EVALUATE_SEEDS);
+    const char* placement_names[] = {"random", "pivot-mds", "community"};
+    const double iteration_factors[] = {0.5, 1.0, 2.0};
+
+    SHOW_PROGRESS = false;
+    DEBUG_PRINT("Evaluating " + std::to_string(seed_nr) + " layouts per setting of " + file_name);
+
+    std::cout << std::left << std::setw(12) << "placement" << std::setw(12) << "components" << std::right << std::setw(12) << "iterations"
+              << std::setw(12) << "ms" << std::setw(12) << "stress" << std::setw(12) << "edge cv" << std::setw(16) << "neighbourhood"
+              << std::setw(16) << "crossings/edge" << std::endl;
+
+    for(int placement : {RANDOM_PLACEMENT, PIVOT_MDS, COMMUNITY_PLACEMENT}){
+        for(bool by_component : {false, true}){
+            for(double factor : iteration_factors){
+                fdl::INITIAL_PLACEMENT = placement;
+                fdl::LAYOUT_BY_COMPONENT = by_component;
+                fdl::FDL_MAX_ITER = std::max(1, (int)(default_max_iter * factor));
+                fdl::PLACED_MAX_ITER = std::max(1, (int)(default_placed_max_iter * factor));
+
+                double ms = 0.0;
+                layout_quality mean = {0.0, 0.0, 0.0, 0.0};
+                for(int i = 0; i < seed_nr; i++){
+                    config::SEED = seed + i;
+
+                    auto t1 = std::chrono::high_resolution_clock::now();
+                    FDL* fdl = fdl_start(graph);
+                    fdl_layout(fdl, graph);
+                    ms += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t1).count();
+
+                    layout_quality quality = measure_layout(graph, fdl->pos, seed);
+                    mean.stress += quality.stress / seed_nr;
+                    mean.edge_length_cv += quality.edge_length_cv / seed_nr;
+                    mean.neighbourhood_preservation += quality.neighbourhood_preservation / seed_nr;
+                    mean.crossings_per_edge += quality.crossings_per_edge / seed_nr;
+                    delete fdl;
+                }
+
+                int iterations = placement == RANDOM_PLACEMENT ? fdl::FDL_MAX_ITER : fdl::PLACED_MAX_ITER;
+                std::cout << std::left << std::setw(12) << placement_names[placement] << std::setw(12) << (by_component ? "packed" : "whole")
+                          << std::right << std::setw(12) << iterations << std::setw(12) << (uint64_t)(ms / seed_nr)
+                          << std::fixed << std::setprecision(4) << std::setw(12) << mean.stress << std::setw(12) << mean.edge_length_cv
+                          << std::setw(16) << mean.neighbourhood_preservation << std::setw(16) << mean.crossings_per_edge
+                          << std::defaultfloat << std::endl;
+            }
+        }
+    }
+
+    fdl::INITIAL_PLACEMENT = default_placement;
+    fdl::LAYOUT_BY_COMPONENT = default_by_component;
+    fdl::FDL_MAX_ITER = default_max_iter;
+    fdl::PLACED_MAX_ITER = default_placed_max_iter;
+    config::SEED = default_seed;
+    SHOW_PROGRESS = true;
+
+    delete graph;
+    return 1;
+}
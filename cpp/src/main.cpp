@@ -2,9 +2,16 @@
 #include "main.h"
 #include "preproc.h"
 #include "force-directed-layout.h"
-#include "preproc.h"
+#include "pipeline.h"
+#include "batch.h"
+#include "layout-quality.h"
+#include "external-preproc.h"
+#include "config.h"
+#include "config-loader.h"
+#include "memory-budget.h"
 
 bool DEBUG_MODE;
+bool SHOW_PROGRESS = true;
 
 void DEBUG_PRINT(std::string str){
     if(DEBUG_MODE){
@@ -13,6 +20,10 @@ void DEBUG_PRINT(std::string str){
 }
 
 void print_progress_bar(double progress){
+    if(!SHOW_PROGRESS){
+        return;
+    }
+
     int barWidth = 70;
 
     std::cout << "[";
@@ -31,6 +42,7 @@ int main(int const argc, char* argv[]){
 
     std::string command;
     std::string arg;
+    bool external = false;
 
     if(argc > 1){
         command = argv[1];
@@ -42,18 +54,34 @@ int main(int const argc, char* argv[]){
             if(arg == "-d"){
                 DEBUG_MODE = true;
             }
+            else if(arg == "-e"){
+                external = true;
+            }
         }
     }
-    
-    Graph* graph;
+
+    if(!config_from_args(argc, argv)){
+        return 0;
+    }
+    config_print();
+
     if(command == "process"){
-        graph = preproc(argv[2], true);
-        fdl_run(argv[2], graph);
+        process_pipeline(argv[2], external);
+    }
+    else if(command == "batch"){
+        process_batch(argv[2], external);
+    }
+    else if(command == "evaluate"){
+        evaluate_layouts(argv[2]);
+    }
+    else if(command == "convert"){
+        txt_to_bin_external(argv[2], config::EXTERNAL_MEMORY_BUDGET);
     }
 
     auto t2 = std::chrono::high_resolution_clock::now();
 
     auto ms_int = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
     std::cout << "Ran for: " << ms_int.count() << "ms" << std::endl;
+    memory_report();
     return 1;
 }
\ No newline at end of file
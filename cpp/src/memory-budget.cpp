@@ -0,0 +1,189 @@
+/**
+ * @brief Implements the memory accounting and the planning under a memory budget.
+ *
+ * The accounting is explicit: the structures that grow with the graph (edge buffer, CSR, layout, snapshots, ...)
+ * report their size when they allocate and free it, everything small is left out. The resident set printed next
+ * to it shows how much is untracked.
+ */
+
+#include "memory-budget.h"
+#include "graph.h"
+#include "config.h"
+#include "main.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+static std::atomic<int64_t> current[MEMORY_SUBSYSTEM_NR];
+static std::atomic<int64_t> peak[MEMORY_SUBSYSTEM_NR];
+static std::atomic<int64_t> total_current(0);
+static std::atomic<int64_t> total_peak(0);
+
+static const char* subsystem_names[MEMORY_SUBSYSTEM_NR] = {"parse", "graph", "layout", "triangles", "queued writes"};
+
+static void raise_to(std::atomic<int64_t>& max, int64_t value){
+    int64_t seen = max.load();
+    while(value > seen && !max.compare_exchange_weak(seen, value)){}
+}
+
+void memory_track(memory_subsystem subsystem, int64_t bytes){
+    raise_to(peak[subsystem], current[subsystem].fetch_add(bytes) + bytes);
+    raise_to(total_peak, total_current.fetch_add(bytes) + bytes);
+}
+
+uint64_t memory_current(){
+    return (uint64_t)std::max<int64_t>(0, total_current.load());
+}
+
+static std::string mib(uint64_t bytes){
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024.0) << " MiB";
+    return out.str();
+}
+
+void memory_report(){
+    std::cout << "Peak memory: " << mib(total_peak.load()) << " tracked (";
+    for(int s = 0; s < MEMORY_SUBSYSTEM_NR; s++){
+        std::cout << (s ? ", " : "") << subsystem_names[s] << " " << mib(peak[s].load());
+    }
+    std::cout << ")";
+#ifdef __linux__
+    rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0){
+        std::cout << ", " << mib((uint64_t)usage.ru_maxrss * 1024) << " resident";
+    }
+#endif
+    if(config::MEMORY_BUDGET){
+        std::cout << ", budget " << mib(config::MEMORY_BUDGET);
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief An upper bound of the lines of the edge list, i.e. of its edges.
+ */
+static uint64_t count_lines(std::string file_name){
+    std::ifstream file(file_name, std::ios::binary);
+    std::vector<char> buffer(1 << 20);
+
+    uint64_t lines = 1;
+    while(file.read(buffer.data(), buffer.size()) || file.gcount() > 0){
+        lines += std::count(buffer.begin(), buffer.begin() + file.gcount(), '\n');
+    }
+
+    return lines;
+}
+
+// Per stored (directed) edge: the delta + varint encoding usually takes one byte, a JSON edge entry about 42.
+static const uint64_t COMPRESSED_BYTES_PER_EDGE = 1;
+static const uint64_t JSON_BYTES_PER_EDGE = 42;
+static const uint64_t JSON_BYTES_PER_VERTEX = 110;
+
+/**
+ * @brief The estimated peak of a run over entries stored edges: the larger of loading the graph and of running
+ * everything that follows at once (as the pipeline does).
+ */
+static uint64_t estimate_peak(const memory_plan& plan, uint64_t entries, bool external){
+    // node ids are 16 bits, which bounds every per vertex array
+    const uint64_t n = (uint64_t)std::numeric_limits<node_int>::max() + 1;
+    const uint64_t vertex_bytes = n * (sizeof(edge_int) + 4 * sizeof(node_int));
+    const uint64_t plain = entries * sizeof(node_int) + vertex_bytes;
+    const uint64_t compressed = entries * COMPRESSED_BYTES_PER_EDGE + vertex_bytes;
+
+    // the edge buffer doubles its capacity while it grows
+    uint64_t parse = 0;
+    if(external){
+        parse = plan.external_budget;
+    }
+    else if(!plan.two_pass_parse){
+        parse = 2 * entries * sizeof(std::pair<node_int, node_int>);
+    }
+    // the external build is done before the binary is read, which compresses it on the way if asked to
+    uint64_t load = external ? std::max(parse, plan.compress ? compressed : plain) : plain + parse;
+    if(config::REORDER_ALGORITHM != 0){
+        load = std::max(load, 2 * plain);
+    }
+    if(plan.compress && !external){
+        load = std::max(load, plain + compressed);
+    }
+
+    uint64_t run = plan.compress ? compressed : plain;
+    run += n * 4 * sizeof(std::pair<double,double>);
+    if(plan.by_component){
+        run += plain;
+    }
+    if(config::WRITE_CLUSTERING || fdl::INCLUDE_CLUSTERING_JSON){
+        run += entries / 2 * sizeof(node_int) + n * sizeof(edge_int);
+    }
+    if(!plan.stream_json){
+        // the string stream and the string it hands out
+        run += 2 * (entries * JSON_BYTES_PER_EDGE + n * JSON_BYTES_PER_VERTEX);
+    }
+
+    return std::max(load, run);
+}
+
+// The estimates of the plans whose runs aren't done yet.
+static std::mutex reserved_mutex;
+static uint64_t reserved_bytes = 0;
+
+memory_plan plan_memory(std::string file_name, bool external){
+    memory_plan plan;
+    plan.compress = config::COMPRESS_ADJACENCY;
+    plan.by_component = fdl::LAYOUT_BY_COMPONENT;
+    plan.external_budget = config::EXTERNAL_MEMORY_BUDGET;
+    if(config::MEMORY_BUDGET == 0){
+        return plan;
+    }
+
+    const uint64_t entries = 2 * count_lines(file_name);
+
+    // what the running jobs accounted is covered by their reservations, unless they outgrew them
+    std::lock_guard<std::mutex> lock(reserved_mutex);
+    const uint64_t used = std::max(reserved_bytes, memory_current());
+    const uint64_t available = config::MEMORY_BUDGET > used ? config::MEMORY_BUDGET - used : 0;
+    if(external){
+        plan.external_budget = std::min(plan.external_budget, available / 2);
+    }
+
+    plan.estimate = estimate_peak(plan, entries, external);
+
+    // cheapest first: streaming only moves the formatting to the I/O thread, the second pass reads the file again,
+    // the whole layout drops the component packing and the compression slows down every walk over the neighbours
+    for(int step = 0; step < 4 && plan.estimate > available; step++){
+        switch(step){
+            case 0: plan.stream_json = true; break;
+            case 1: plan.two_pass_parse = !external; break;
+            case 2: plan.by_component = false; break;
+            case 3: plan.compress = true; break;
+        }
+        plan.estimate = estimate_peak(plan, entries, external);
+    }
+
+    DEBUG_PRINT("Memory plan for " + file_name + ": " + mib(plan.estimate) + " estimated, " + mib(available) + " available"
+                + (plan.stream_json ? ", streamed JSON" : "") + (plan.two_pass_parse ? ", two pass parse" : "")
+                + (plan.by_component ? "" : ", whole layout") + (plan.compress ? ", compressed adjacency" : ""));
+    if(plan.estimate > available){
+        std::cerr << "memory-budget.cpp: " << file_name << " is estimated to need " << mib(plan.estimate) << " even so, only "
+                  << mib(available) << " of the budget are left" << std::endl;
+    }
+
+    plan.reserved = plan.estimate;
+    reserved_bytes += plan.reserved;
+
+    return plan;
+}
+
+void memory_release(const memory_plan& plan){
+    std::lock_guard<std::mutex> lock(reserved_mutex);
+    reserved_bytes -= plan.reserved;
+}
@@ -0,0 +1,246 @@
+/**
+ * @brief Runs the 'process' command as a task graph instead of strictly one stage after the other:
+ *
+ *      txt_to_graph -> prepare_graph -+-> graph_to_bin (I/O)
+ *                                     +-> find_communities -> communities_to_bin (I/O) -+
+ *                                     +-> rank_graph -----------------------------------+-> JSON snapshots (I/O)
+ *                                     +-> count_triangles -> clustering (I/O) ----------+
+ *                                     +-> fdl_start -> fdl_layout ----------------------+-> spatial index (I/O)
+ *                                                           +-> frames (own I/O thread)
+ *
+ * The independent stages run on a thread pool and every file is written by a single background I/O thread, so
+ * the wall time approaches the one of the longest stage (usually the layout) instead of the sum of all of them.
+ * Only the calling thread waits on futures (and builds the snapshots in between). It waits through
+ * ThreadPool::wait, so it helps with the queued tasks meanwhile, which also makes it safe to run a pipeline as a
+ * task of the very pool it uses (see process_batch).
+ */
+
+#include "pipeline.h"
+#include "main.h"
+#include "config.h"
+#include "preproc.h"
+#include "ranking.h"
+#include "triangles.h"
+#include "reorder.h"
+#include "initial-placement.h"
+#include "force-directed-layout.h"
+#include "spatial-index.h"
+#include "thread-pool.h"
+#include "io-writer.h"
+#include "external-preproc.h"
+#include "memory-budget.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+/**
+ * @brief Runs f and reports its duration in the debug output.
+ */
+template<typename F> auto timed_stage(std::string name, F f) -> decltype(f()) {
+    auto t1 = std::chrono::high_resolution_clock::now();
+    struct report{
+        std::string name;
+        std::chrono::high_resolution_clock::time_point t1;
+        ~report(){
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - t1);
+            DEBUG_PRINT("Stage " + name + " took " + std::to_string(ms.count()) + "ms, "
+                        + std::to_string(memory_current() >> 20) + " MiB tracked");
+        }
+    } r{name, t1};
+
+    return f();
+}
+
+/**
+ * @param       external    Builds the '-graph.bin' out of core first (see txt_to_bin_external) and loads the graph from it
+ * @param       shared_pool If set, the tasks run on this pool instead of an own one
+ * @param       shared_io   If set, the files are written by this writer instead of an own one
+ * @param       stats       If set, receives the size of the graph and the wall time
+ */
+int process_pipeline(std::string file_name, bool external, ThreadPool* shared_pool, IOWriter* shared_io, pipeline_stats* stats){
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    std::unique_ptr<ThreadPool> own_pool;
+    if(!shared_pool){
+        own_pool.reset(new ThreadPool(config::PIPELINE_THREADS));
+        shared_pool = own_pool.get();
+    }
+    ThreadPool& pool = *shared_pool;
+
+    std::unique_ptr<IOWriter> own_io;
+    if(!shared_io){
+        own_io.reset(new IOWriter());
+        shared_io = own_io.get();
+    }
+    IOWriter& io = *shared_io;
+    // a shared writer also writes for others, so only the own files are waited for
+    std::vector<std::future<void>> written;
+
+    DEBUG_PRINT("Pipeline started with " + std::to_string(pool.get_thread_nr()) + " threads");
+
+    // without config::MEMORY_BUDGET this is just the config
+    const memory_plan plan = plan_memory(file_name, external);
+
+    Graph* graph = timed_stage("load", [&](){
+        Graph* g = nullptr;
+        if(external){
+            // a failed conversion may leave the binary of an earlier run behind
+            if(txt_to_bin_external(file_name, plan.external_budget)){
+                g = bin_to_graph(file_name, plan.compress);
+            }
+        }
+        else{
+            g = txt_to_graph(file_name, plan.two_pass_parse);
+        }
+        if(g){
+            prepare_graph(g);
+            if(plan.compress){
+                g->compress();
+            }
+        }
+        return g;
+    });
+    if(!graph){
+        memory_release(plan);
+        return 0;
+    }
+    if(stats){
+        stats->vertex_nr = graph->get_vertex_nr();
+        stats->edge_nr = graph->get_edge_nr();
+    }
+
+    // A community based reordering relabels the whole graph, so everything else has to wait for it.
+    bool relabel_after_communities = (reorder_algorithm)config::REORDER_ALGORITHM == COMMUNITY_CONTIGUOUS;
+    std::future<int> communities_done;
+    if(relabel_after_communities){
+        timed_stage("communities", [&](){ return find_communities(graph); });
+        finish_graph(graph);
+    }
+    else{
+        communities_done = pool.submit([graph](){
+            return timed_stage("communities", [graph](){ return find_communities(graph); });
+        });
+    }
+
+    // From here on the CSR is read only, the label propagation only writes the communities.
+    // The external build already wrote the binary, unless it was changed since.
+    if(!external || graph->is_relabelled() || graph->is_compressed()){
+        written.push_back(io.submit([file_name, graph](){
+            graph_to_bin(file_name, graph);
+            order_to_bin(file_name, graph);
+        }));
+    }
+
+    const bool count_clustering = config::WRITE_CLUSTERING || fdl::INCLUDE_CLUSTERING_JSON;
+    // the clustering ranks come from the triangle counts below, if those are counted anyway
+    const bool rank_from_triangles = fdl::INCLUDE_RANK_JSON && count_clustering
+                                     && (ranking_algorithm)config::RANKING_ALGORITHM == CLUSTERING_COEFFICIENT;
+    std::future<std::vector<node_int>> ranking_done = pool.submit([graph, rank_from_triangles](){
+        return timed_stage("ranking", [graph, rank_from_triangles](){
+            std::vector<node_int> ranking;
+            if(fdl::INCLUDE_RANK_JSON && !rank_from_triangles){
+                ranking = rank_graph(graph, (ranking_algorithm)config::RANKING_ALGORITHM);
+            }
+            return ranking;
+        });
+    });
+
+    std::future<triangle_counts> triangles_done;
+    if(count_clustering){
+        triangles_done = pool.submit([graph](){
+            return timed_stage("triangles", [graph](){ return count_triangles(graph, config::PIPELINE_THREADS); });
+        });
+    }
+
+    // a community based start needs the communities first (per component too, see layout_component), every other
+    // placement leaves them to the label propagation running alongside the layout
+    if((initial_placement)fdl::INITIAL_PLACEMENT == COMMUNITY_PLACEMENT && communities_done.valid()){
+        pool.wait(communities_done);
+    }
+    const bool by_component = plan.by_component;
+    FDL* fdl = fdl_start(graph, by_component);
+    std::vector<std::pair<double,double>> start_pos = fdl->pos;
+    // the recorder brings its own writer thread, so recording never waits behind the other files
+    FrameRecorder* recorder = nullptr;
+    if(fdl::RECORD_FRAMES){
+        recorder = new FrameRecorder(file_name, graph, (frame_precision)fdl::RECORD_PRECISION, fdl::RECORD_STRIDE);
+    }
+    std::future<void> layout_done = pool.submit([fdl, graph, recorder, by_component](){
+        timed_stage("layout", [fdl, graph, recorder, by_component](){ fdl_layout(fdl, graph, recorder, by_component); });
+    });
+
+    if(communities_done.valid()){
+        pool.wait(communities_done);
+    }
+    written.push_back(io.submit([file_name, graph](){
+        communities_to_bin(file_name, graph, 0);
+    }));
+
+    std::vector<node_int> ranking = pool.wait(ranking_done);
+
+    std::vector<double> clustering;
+    if(triangles_done.valid()){
+        triangle_counts triangles = pool.wait(triangles_done);
+        clustering = triangles.clustering;
+        if(rank_from_triangles){
+            ranking = rank_clustering(triangles);
+        }
+        if(config::WRITE_CLUSTERING){
+            written.push_back(io.submit([file_name, graph, triangles](){
+                clustering_to_bin(file_name, graph, triangles);
+            }));
+        }
+    }
+
+    // A snapshot is as large as a few dozen CSRs. Under a budget it is written straight into its file on the I/O
+    // thread, otherwise it's built here in memory, so the I/O thread only has to copy it to the disk.
+    auto snapshot = [&](int number, const std::vector<std::pair<double,double>>& pos){
+        std::string path = fdl_json_path(file_name, number);
+        if(plan.stream_json){
+            return io.submit([path, graph, &pos, &ranking, &clustering](){
+                std::ofstream out(path, std::ios::binary);
+                if(!out.is_open()){
+                    std::cerr << "[ERROR] could not open " << path << " for writing\n";
+                    return;
+                }
+                fdl_json(out, graph, pos, ranking, clustering);
+            });
+        }
+        return io.write(path, timed_stage(number == 0 ? "initial snapshot" : "final snapshot", [&](){
+            return fdl_json(graph, pos, ranking, clustering);
+        }));
+    };
+
+    // the initial snapshot only needs the start positions, so it's built while the layout is still running
+    written.push_back(snapshot(0, start_pos));
+
+    pool.wait(layout_done);
+    delete recorder;
+
+    written.push_back(snapshot(1, fdl->pos));
+
+    if(fdl::WRITE_SPATIAL_INDEX){
+        SpatialIndex* index = spatial_index_build(fdl->pos, graph);
+        written.push_back(io.submit([file_name, index](){
+            spatial_index_to_bin(file_name, index);
+            delete index;
+        }));
+    }
+
+    timed_stage("waiting for I/O", [&](){
+        for(std::future<void>& f : written){
+            f.wait();
+        }
+    });
+
+    DEBUG_PRINT("Pipeline exited");
+
+    delete fdl;
+    delete graph;
+    memory_release(plan);
+
+    if(stats){
+        stats->seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t1).count();
+    }
+    return 1;
+}
@@ -1,116 +1,317 @@
 #include "preproc.h"
 #include "graph.h"
 #include "config.h"
+#include "config-loader.h"
 #include "labelprop.h"
+#include "reorder.h"
+#include "main.h"
+#include "memory-budget.h"
 #include <fstream>
 #include <string>
 #include <vector>
-#include <sstream>
 #include <iostream>
 #include <cstdint>
+#include <cstring>
+#include <cstdlib>
 #include <filesystem>
+#include <limits>
 
-Graph* txt_to_graph(std::string dir){
-    std::ifstream in_file(dir);
-    
-    std::vector<std::pair<node_int, node_int>> edges;
+int parse_edge(const std::string& line, node_int& idA, node_int& idB){
+    const char* begin = line.c_str();
+    char* end;
+    unsigned long a = std::strtoul(begin, &end, 10);
+    if(end == begin){
+        return 0; // empty or malformed line
+    }
+    begin = end;
+    unsigned long b = std::strtoul(begin, &end, 10);
+    if(end == begin){
+        return 0;
+    }
+    if(a > std::numeric_limits<node_int>::max() || b > std::numeric_limits<node_int>::max()){
+        std::cerr << "preproc.cpp: node id out of range: " << line << std::endl;
+        return 0;
+    }
+
+    idA = (node_int)a;
+    idB = (node_int)b;
+    return 1;
+}
+
+/**
+ * @brief Calls f(idA, idB) for the edge on every line of the edge list (see parse_edge), the same way on every pass.
+ */
+template<typename F> static void for_each_edge(std::ifstream& in_file, F f){
     std::string line;
     node_int idA;
     node_int idB;
+    while(std::getline(in_file, line)){
+        if(parse_edge(line, idA, idB)){
+            f(idA, idB);
+        }
+    }
+}
+
+/**
+ * @brief The edge buffer is the largest temporary, it's kept per thread so that a batch of graphs (see process_batch)
+ * reuses its capacity instead of allocating it again for every graph.
+ */
+struct edge_buffer{
+    std::vector<std::pair<node_int, node_int>> edges;
+    int64_t tracked_bytes = 0;
+
+    void track_memory(){
+        int64_t bytes = edges.capacity() * sizeof(std::pair<node_int, node_int>);
+        memory_track(MEMORY_PARSE, bytes - tracked_bytes);
+        tracked_bytes = bytes;
+    }
+    ~edge_buffer(){
+        memory_track(MEMORY_PARSE, -tracked_bytes);
+    }
+};
+
+/**
+ * @brief Reads an edge list into a Graph, nullptr if the file can't be opened.
+ *
+ * @param       two_pass    Reads the file twice, first for the degrees and then for the targets, instead of
+ *                          buffering every edge in between. Gives the same graph with a third of the footprint.
+ */
+Graph* txt_to_graph(std::string dir, bool two_pass){
+    std::ifstream in_file(dir);
+    if(!in_file.is_open()){
+        std::cerr << "preproc.cpp: could not open " << dir << std::endl;
+        return nullptr;
+    }
+    
+    static thread_local edge_buffer buffer;
+    std::vector<std::pair<node_int, node_int>>& edges = buffer.edges;
+    edges.clear();
     node_int vertex_nr;
     //node_int edge_nr;
     
     //edge_nr = 0;
     vertex_nr = 0;
-    while(std::getline(in_file, line)){
-        std::istringstream iss(line);
-        iss >> idA >> idB;
-
-        edges.push_back({idA, idB});
-        edges.push_back({idB, idA}); // for undirected
+    // counted for every possible id, as the number of vertices is only known at the end
+    std::vector<edge_int> degrees((size_t)std::numeric_limits<node_int>::max() + 1, 0);
+    for_each_edge(in_file, [&](node_int idA, node_int idB){
+        if(!two_pass){
+            edges.push_back({idA, idB});
+            edges.push_back({idB, idA}); // for undirected
+        }
+        degrees[idA]++;
+        degrees[idB]++;
         vertex_nr = std::max(vertex_nr, std::max(idA, idB));
-    }
-    in_file.close();
+    });
+    buffer.track_memory();
     
     vertex_nr++;
-    
-    std::vector<node_int> degrees(vertex_nr, 0);
-    for(auto &e : edges){
-        degrees[e.first]++;
-    }
+    degrees.resize(vertex_nr);
+    degrees.shrink_to_fit();
 
-    std::vector<node_int> offsets(vertex_nr + 1, 0);
+    std::vector<edge_int> offsets(vertex_nr + 1, 0);
     for(node_int i = 0; i < vertex_nr; i++){
         offsets[i + 1] = offsets[i] + degrees[i];
     }
 
-    std::vector<node_int> writepos(vertex_nr, 0);
+    std::vector<edge_int> writepos(vertex_nr, 0);
     std::vector<node_int> targets(offsets[vertex_nr]);
-    for(auto &e : edges){
-        idA = e.first;
-        idB = e.second;
+    auto insert = [&](node_int idA, node_int idB){
         targets[offsets[idA] + writepos[idA]] = idB;
         
         writepos[idA]++;
+    };
+    if(two_pass){
+        in_file.clear();
+        in_file.seekg(0);
+        for_each_edge(in_file, [&](node_int idA, node_int idB){
+            insert(idA, idB);
+            insert(idB, idA);
+        });
     }
+    else{
+        for(auto &e : edges){
+            insert(e.first, e.second);
+        }
+    }
+    in_file.close();
 
     std::vector<node_int> communities(vertex_nr);
     for(node_int i = 0; i < vertex_nr; i++){
         communities[i] = i;
     }
 
-    Graph* graph = new Graph(offsets[vertex_nr], vertex_nr, offsets, targets, degrees, communities);
+    const edge_int edge_nr = offsets[vertex_nr];
+    Graph* graph = new Graph(edge_nr, vertex_nr, std::move(offsets), std::move(targets), std::move(communities));
+
+    // under a budget nothing is kept for the next graph
+    if(config::MEMORY_BUDGET){
+        std::vector<std::pair<node_int, node_int>>().swap(edges);
+        buffer.track_memory();
+    }
 
     return graph;
 }
 
+/**
+ * @brief Creates the binary of a compressed graph (version 0x02). It uses the format:
+ *
+ *      [[Type (8 bits)]-[Version (8 bits)]-[Node count (64 bits)]-[Edge count (64 bits)]] <- Header
+ *      [[Byte offsets (64 bits each)]-[Byte count (64 bits)]-[Bytes]] <- Payload
+ *
+ * see CompressedAdjacency for the encoding of the bytes. Every list starts with its length, so there are no offsets.
+ */
+int compressed_graph_to_bin(std::string file_name, Graph* graph){
+    std::ofstream file;
+    file.open(file_name.substr(0, file_name.size() - 4)+ "-graph.bin", std::ios::binary);
+
+    uint8_t type_block = 0x00;
+    uint8_t version_block = 0x02;
+    uint64_t node_count_block = graph->get_vertex_nr();
+    uint64_t edge_count_block = graph->get_edge_nr();
+    CompressedAdjacency& adjacency = graph->get_compressed_adjacency();
+    uint64_t byte_count = adjacency.get_bytes().size();
+
+    // Insert header
+    file.write((char*)&type_block, sizeof(uint8_t));
+    file.write((char*)&version_block, sizeof(uint8_t));
+    file.write((char*)&node_count_block, sizeof(uint64_t));
+    file.write((char*)&edge_count_block, sizeof(uint64_t));
+    // Insert payload
+    file.write((char*)adjacency.get_byte_offsets().data(), adjacency.get_byte_offsets().size() * sizeof(uint64_t));
+    file.write((char*)&byte_count, sizeof(uint64_t));
+    file.write((char*)adjacency.get_bytes().data(), byte_count);
+
+    file.close();
+    return 1;
+}
+
 /**
  * @brief Creates the binary CSR from the Graph class. It uses the format:
  *      
  *      [[Type (8 bits)]-[Version (8 bits)]-[Node count (64 bits)]-[Edge count (64 bits)]] <- Header
- *      [[Offsets]-[Targets]] <- Payload
+ *      [[Offsets (64 bits each)]-[Targets (node_int each)]] <- Payload
+ *
+ * The payload is written straight from the CSR, without an intermediate copy of the file.
  */
 int graph_to_bin(std::string file_name, Graph* graph){
+    if(graph->is_compressed()){
+        return compressed_graph_to_bin(file_name, graph);
+    }
 
     std::ofstream file;
     file.open(file_name.substr(0, file_name.size() - 4)+ "-graph.bin", std::ios::binary);
 
     uint8_t type_block = 0x00;
     uint8_t version_block = 0x00;
-    node_int node_count_block = graph->get_vertex_nr();
-    node_int edge_count_block = graph->get_edge_nr();
-    std::vector<node_int> offsets_vector = graph->get_offsets();
-    std::vector<node_int> targets_vector = graph->get_targets();
-
-    node_int offset_size = node_count_block + 1;
-    node_int targets_size = edge_count_block;
+    uint64_t node_count_block = graph->get_vertex_nr();
+    uint64_t edge_count_block = graph->get_edge_nr();
+    std::vector<edge_int>& offsets_vector = graph->get_offsets();
+    std::vector<node_int>& targets_vector = graph->get_targets();
 
-    
-    node_int header_size = (2 * sizeof(uint8_t)) + (2 * sizeof(node_int));
-    node_int payload_size = offset_size * sizeof(node_int) + targets_size * sizeof(node_int);
-    
-    node_int file_size = header_size + payload_size;
-    
-    char* data = new char[file_size];
     // Insert header
-    data[0] = type_block;
-    data[1] = version_block;
-    memcpy(data + 2, &node_count_block, sizeof(node_int));
-    memcpy(data + 2 + sizeof(node_int), &edge_count_block, sizeof(node_int));
+    file.write((char*)&type_block, sizeof(uint8_t));
+    file.write((char*)&version_block, sizeof(uint8_t));
+    file.write((char*)&node_count_block, sizeof(uint64_t));
+    file.write((char*)&edge_count_block, sizeof(uint64_t));
     // Insert payload
-    for (node_int i = 0; i < offset_size; i++) {
-        memcpy(data + header_size + i * sizeof(node_int), &offsets_vector[i], sizeof(node_int));
+    file.write((char*)offsets_vector.data(), (node_count_block + 1) * sizeof(edge_int));
+    file.write((char*)targets_vector.data(), edge_count_block * sizeof(node_int));
+
+    file.close();
+    return 1;
+}
+
+/**
+ * @brief Reads the '-graph.bin' (any version) of the given data set back into a Graph, restoring the relabelling
+ * from the '-order.bin' if there is one. The communities start out as one per node.
+ *
+ * The file is read, not mapped: every stage needs random access to the adjacency and the ids are relabelled in
+ * place, so the graph has to fit into memory either way. To get the most out of it, a plain binary can be compressed
+ * while reading.
+ *
+ * @param       file_name   The path of the data set, as for graph_to_bin
+ * @param       compress    Compresses a plain binary a list at a time while reading it, so its targets are never
+ *                          in memory as a whole
+ */
+Graph* bin_to_graph(std::string file_name, bool compress){
+    std::string base_name = file_name.substr(0, file_name.size() - 4);
+    std::ifstream file(base_name + "-graph.bin", std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "preproc.cpp: could not open " << base_name << "-graph.bin" << std::endl;
+        return nullptr;
+    }
+
+    uint8_t type_block;
+    uint8_t version_block;
+    uint64_t node_count_block;
+    uint64_t edge_count_block;
+    file.read((char*)&type_block, sizeof(uint8_t));
+    file.read((char*)&version_block, sizeof(uint8_t));
+    file.read((char*)&node_count_block, sizeof(uint64_t));
+    file.read((char*)&edge_count_block, sizeof(uint64_t));
+
+    node_int vertex_nr = node_count_block;
+    std::vector<node_int> communities(vertex_nr);
+    for(node_int i = 0; i < vertex_nr; i++){
+        communities[i] = i;
     }
-    for (node_int i = 0; i < targets_size; i++) {
-        memcpy(data + header_size + offset_size * sizeof(node_int) + i * sizeof(node_int), &targets_vector[i], sizeof(node_int));
+
+    Graph* graph;
+    if(version_block == 0x02){
+        std::vector<uint64_t> byte_offsets(node_count_block + 1);
+        uint64_t byte_count;
+        file.read((char*)byte_offsets.data(), byte_offsets.size() * sizeof(uint64_t));
+        file.read((char*)&byte_count, sizeof(uint64_t));
+        std::vector<uint8_t> bytes(byte_count);
+        file.read((char*)bytes.data(), byte_count);
+
+        graph = new Graph(edge_count_block, vertex_nr, {}, {}, std::move(communities));
+        graph->set_compressed_adjacency(CompressedAdjacency(std::move(byte_offsets), std::move(bytes)));
     }
+    else{
+        std::vector<edge_int> offsets(node_count_block + 1);
+        file.read((char*)offsets.data(), offsets.size() * sizeof(edge_int));
 
+        if(compress){
+            std::vector<uint64_t> byte_offsets(1, 0);
+            byte_offsets.reserve(node_count_block + 1);
+            std::vector<uint8_t> bytes;
+            // most gaps and lengths take a single byte, as in compress_adjacency
+            bytes.reserve(edge_count_block + node_count_block);
+            std::vector<node_int> neighbors;
+            for(node_int v = 0; v < vertex_nr && file; v++){
+                neighbors.resize(offsets[v + 1] - offsets[v]);
+                file.read((char*)neighbors.data(), neighbors.size() * sizeof(node_int));
+                append_neighbors(byte_offsets, bytes, neighbors);
+            }
+            bytes.shrink_to_fit();
 
-    file.write(data, file_size);
+            graph = new Graph(edge_count_block, vertex_nr, {}, {}, std::move(communities));
+            graph->set_compressed_adjacency(CompressedAdjacency(std::move(byte_offsets), std::move(bytes)));
+        }
+        else{
+            std::vector<node_int> targets(edge_count_block);
+            file.read((char*)targets.data(), targets.size() * sizeof(node_int));
 
+            graph = new Graph(edge_count_block, vertex_nr, std::move(offsets), std::move(targets), std::move(communities));
+        }
+    }
+
+    if(!file){
+        std::cerr << "preproc.cpp: " << base_name << "-graph.bin is truncated" << std::endl;
+        delete graph;
+        return nullptr;
+    }
     file.close();
-    delete[] data;
-    return 1;
+
+    std::ifstream order_file(base_name + "-order.bin", std::ios::binary);
+    if(order_file.is_open()){
+        std::vector<node_int> original_ids(vertex_nr);
+        order_file.read((char*)original_ids.data(), original_ids.size() * sizeof(node_int));
+        graph->set_original_ids(original_ids);
+    }
+
+    return graph;
 }
 
 /**
@@ -119,13 +320,15 @@ int graph_to_bin(std::string file_name, Graph* graph){
 int communities_to_bin(std::string file_name, Graph* graph, int iteration){
     std::ofstream file;
     file.open(file_name.substr(0, file_name.size() - 4)+ "-communities-" + std::to_string(iteration) + ".bin", std::ios::binary);
-    std::vector<node_int> communities = graph->get_communities();
+    std::vector<node_int>& communities = graph->get_communities();
 
     node_int node_count = graph->get_vertex_nr();
     char* data = new char[node_count * sizeof(node_int)];
 
+    // Written in the order (and with the ids) of the input file, even if the graph was relabelled.
     for(node_int i = 0; i < node_count; i++){
-        memcpy(data + i * sizeof(node_int), &communities[i], sizeof(node_int));
+        node_int label = graph->get_original_id(communities[i]);
+        memcpy(data + graph->get_original_id(i) * sizeof(node_int), &label, sizeof(node_int));
     }
 
     file.write(data, node_count * sizeof(node_int));
@@ -135,6 +338,75 @@ int communities_to_bin(std::string file_name, Graph* graph, int iteration){
     return 1;
 }
 
+/**
+ * @brief Writes the mapping from the internal ids used in '-graph.bin' back to the ids of the input file
+ * (one node_int per internal id). Only written if the graph was relabelled, otherwise a stale one from an
+ * earlier run is removed, as bin_to_graph would apply it.
+ */
+int order_to_bin(std::string file_name, Graph* graph){
+    if(!graph->is_relabelled()){
+        std::error_code error;
+        std::filesystem::remove(file_name.substr(0, file_name.size() - 4)+ "-order.bin", error);
+        return 1;
+    }
+
+    std::ofstream file;
+    file.open(file_name.substr(0, file_name.size() - 4)+ "-order.bin", std::ios::binary);
+
+    std::vector<node_int>& original_ids = graph->get_original_ids();
+    file.write((char*)original_ids.data(), original_ids.size() * sizeof(node_int));
+
+    file.close();
+    return 1;
+}
+
+/**
+ * @brief Applies the vertex reordering and the compression selected in the config, in that order, as small gaps
+ * between neighbour ids is what makes the compression work. A community based reordering is skipped here, see
+ * finish_graph.
+ */
+int prepare_graph(Graph* graph){
+    reorder_algorithm reorder = (reorder_algorithm)config::REORDER_ALGORITHM;
+    if(reorder != COMMUNITY_CONTIGUOUS){
+        reorder_graph(graph, reorder);
+    }
+
+    if(config::COMPRESS_ADJACENCY){
+        size_t raw_size = graph->get_targets().size() * sizeof(node_int);
+        graph->compress();
+        DEBUG_PRINT("Compressed targets from " + std::to_string(raw_size) + " to "
+                    + std::to_string(graph->get_compressed_adjacency().size_in_bytes()) + " bytes");
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Runs the label propagation for config::MAX_PROP_ITER iterations.
+ */
+int find_communities(Graph* graph){
+    // label_prop breaks ties with this, seeded per call so the communities don't depend on other graphs
+    std::mt19937 rng(config_seed());
+
+    for(int iteration = 1; iteration < config::MAX_PROP_ITER; iteration++){
+        label_prop(graph, rng);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Applies the community based reordering, if selected. The communities only exist after find_communities,
+ * so this has to run after it.
+ */
+int finish_graph(Graph* graph){
+    if((reorder_algorithm)config::REORDER_ALGORITHM == COMMUNITY_CONTIGUOUS){
+        reorder_graph(graph, COMMUNITY_CONTIGUOUS);
+    }
+
+    return 1;
+}
+
 /**
  * @brief Preprocessor for the graph. This function turns a simple textfile (txt) into a binary CSR.
  * 
@@ -142,17 +414,21 @@ int communities_to_bin(std::string file_name, Graph* graph, int iteration){
  */
 Graph* preproc(std::string dir, bool communities){
     Graph* graph = txt_to_graph(dir);
+    if(!graph){
+        return nullptr;
+    }
+    prepare_graph(graph);
     
     if(communities){
         communities_to_bin(dir, graph, 0);
-        for(uint64_t iteration = 1; iteration < config::MAX_PROP_ITER; iteration++){
-            label_prop(graph);
-            //communities_to_bin(dir, graph, iteration);            
-        }
+        find_communities(graph);
     }
     communities_to_bin(dir, graph, 0);
 
+    finish_graph(graph);
+
     graph_to_bin(dir, graph);
+    order_to_bin(dir, graph);
 
     return graph;
 }
\ No newline at end of file
@@ -1,15 +1,34 @@
 #include "ranking.h"
+#include "triangles.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 std::vector<node_int> rank_neighbourhood(Graph* graph){
     std::vector<node_int> ranking (graph->get_vertex_nr(), 0);
 
     for(node_int v = 0; v < graph->get_vertex_nr(); v++){
-        ranking[v] = graph->get_adj_matrix()[v].size();
+        // ranks are node_int, a degree beyond that (only possible with multi-edges) saturates
+        ranking[v] = (node_int)std::min<edge_int>(graph->get_degree(v), std::numeric_limits<node_int>::max());
     }
 
     return ranking;
 }
 
+std::vector<node_int> rank_clustering(const triangle_counts& counts){
+    std::vector<node_int> ranking (counts.clustering.size(), 0);
+
+    for(size_t v = 0; v < counts.clustering.size(); v++){
+        ranking[v] = (node_int)std::lround(counts.clustering[v] * 1000.0);
+    }
+
+    return ranking;
+}
+
+std::vector<node_int> rank_clustering(Graph* graph){
+    return rank_clustering(count_triangles(graph, config::PIPELINE_THREADS));
+}
+
 std::vector<node_int> rank_graph(Graph* graph, ranking_algorithm algorithm){
     std::vector<node_int> ranking;
 
@@ -23,6 +42,9 @@ std::vector<node_int> rank_graph(Graph* graph, ranking_algorithm algorithm){
         case NEIGHBOURHOOD:
             ranking = rank_neighbourhood(graph);
             break;
+        case CLUSTERING_COEFFICIENT:
+            ranking = rank_clustering(graph);
+            break;
         default:
             std::cerr << "ranking.cpp: No valid ranking algorithm was selected." << std::endl;
             break;
@@ -0,0 +1,137 @@
+/**
+ * @brief This file implements vertex reorderings which relabel the CSR so that neighbouring vertices get
+ * nearby ids. This cuts the cache misses in every kernel walking the adjacency (label propagation, FDL, ranking).
+ */
+
+#include "reorder.h"
+#include "main.h"
+#include <algorithm>
+#include <numeric>
+#include <iostream>
+
+/**
+ * @brief Turns a list of vertices in their new order into a permutation (old id -> new id).
+ */
+static std::vector<node_int> order_to_permutation(const std::vector<node_int>& order){
+    std::vector<node_int> perm(order.size());
+    for(size_t i = 0; i < order.size(); i++){
+        perm[order[i]] = (node_int)i;
+    }
+
+    return perm;
+}
+
+std::vector<node_int> reorder_degree_sort(Graph* graph){
+    std::vector<edge_int> degrees = graph->get_degrees();
+
+    std::vector<node_int> order(graph->get_vertex_nr());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&degrees](node_int a, node_int b){
+        return degrees[a] > degrees[b];
+    });
+
+    return order_to_permutation(order);
+}
+
+std::vector<node_int> reorder_rcm(Graph* graph){
+    std::vector<edge_int> degrees = graph->get_degrees();
+    const node_int n = graph->get_vertex_nr();
+
+    // Start every component from a vertex of minimal degree, which keeps the BFS levels narrow.
+    std::vector<node_int> by_degree(n);
+    std::iota(by_degree.begin(), by_degree.end(), 0);
+    std::stable_sort(by_degree.begin(), by_degree.end(), [&degrees](node_int a, node_int b){
+        return degrees[a] < degrees[b];
+    });
+
+    std::vector<bool> visited(n, false);
+    std::vector<node_int> order;
+    order.reserve(n);
+    std::vector<node_int> neighbours;
+
+    for(node_int start : by_degree){
+        if(visited[start]){
+            continue;
+        }
+
+        visited[start] = true;
+        size_t head = order.size();
+        order.push_back(start);
+
+        // The BFS queue is the tail of order itself.
+        while(head < order.size()){
+            node_int v = order[head++];
+
+            neighbours.clear();
+            graph->for_each_neighbor(v, [&](node_int u){
+                if(!visited[u]){
+                    visited[u] = true;
+                    neighbours.push_back(u);
+                }
+            });
+            std::sort(neighbours.begin(), neighbours.end(), [&degrees](node_int a, node_int b){
+                return degrees[a] < degrees[b];
+            });
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+
+    return order_to_permutation(order);
+}
+
+std::vector<node_int> reorder_community(Graph* graph){
+    auto& communities = graph->get_communities();
+    std::vector<edge_int> degrees = graph->get_degrees();
+
+    std::vector<node_int> order(graph->get_vertex_nr());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&communities, &degrees](node_int a, node_int b){
+        if(communities[a] != communities[b]){
+            return communities[a] < communities[b];
+        }
+        return degrees[a] > degrees[b];
+    });
+
+    return order_to_permutation(order);
+}
+
+std::vector<node_int> reorder_permutation(Graph* graph, reorder_algorithm algorithm){
+    std::vector<node_int> perm;
+
+    switch(algorithm){
+        case NO_REORDER:
+            break;
+        case DEGREE_SORT:
+            perm = reorder_degree_sort(graph);
+            break;
+        case REVERSE_CUTHILL_MCKEE:
+            perm = reorder_rcm(graph);
+            break;
+        case COMMUNITY_CONTIGUOUS:
+            perm = reorder_community(graph);
+            break;
+        default:
+            std::cerr << "reorder.cpp: No valid reorder algorithm was selected." << std::endl;
+            break;
+    }
+
+    return perm;
+}
+
+/**
+ * @brief Relabels the graph according to the chosen algorithm. The graph remembers the permutation, so
+ * every output can map the ids back to the ones in the input file.
+ */
+int reorder_graph(Graph* graph, reorder_algorithm algorithm){
+    std::vector<node_int> perm = reorder_permutation(graph, algorithm);
+    if(perm.empty()){
+        return 1;
+    }
+
+    DEBUG_PRINT("Reordering graph with algorithm " + std::to_string((int)algorithm));
+    graph->relabel(perm);
+
+    return 1;
+}
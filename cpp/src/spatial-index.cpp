@@ -0,0 +1,289 @@
+/**
+ * @brief Implements a bulk-built, implicit k-d tree over the layout positions so that box, radius and
+ * k-nearest queries are logarithmic instead of a scan over all of FDL::pos.
+ */
+
+#include "spatial-index.h"
+#include "config.h"
+#include "main.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <cstring>
+
+static inline double axis_value(const std::pair<double,double>& p, int axis){
+    return axis == 0 ? p.first : p.second;
+}
+
+/**
+ * @brief Recursively places the median of [begin, end) (along the current axis) in the middle of the range.
+ */
+static void build_rec(std::vector<size_t>& order, const std::vector<std::pair<double,double>>& pos, size_t begin, size_t end, int depth){
+    if(end - begin <= 1){
+        return;
+    }
+
+    size_t mid = (begin + end) / 2;
+    int axis = depth % 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+        [&pos, axis](size_t a, size_t b){
+            return axis_value(pos[a], axis) < axis_value(pos[b], axis);
+    });
+
+    build_rec(order, pos, begin, mid, depth + 1);
+    build_rec(order, pos, mid + 1, end, depth + 1);
+}
+
+/**
+ * @brief Builds the index from the final layout. Isolated nodes are left out unless they are also shown in
+ * the JSON, and ids are those of the input file, so that the index always matches what is drawn.
+ */
+SpatialIndex* spatial_index_build(const std::vector<std::pair<double,double>>& pos, Graph* graph){
+    std::vector<size_t> order;
+    order.reserve(pos.size());
+    for(size_t v = 0; v < pos.size(); v++){
+        if(graph->get_degree(v) == 0 && !fdl::SHOW_ISOLATED_NODES_JSON){
+            continue;
+        }
+        order.push_back(v);
+    }
+
+    build_rec(order, pos, 0, order.size(), 0);
+
+    std::vector<std::pair<double,double>> points(order.size());
+    std::vector<node_int> ids(order.size());
+    for(size_t i = 0; i < order.size(); i++){
+        points[i] = pos[order[i]];
+        ids[i] = graph->get_original_id((node_int)order[i]);
+    }
+
+    return new SpatialIndex(points, ids);
+}
+
+size_t SpatialIndex::size(){
+    return this->points.size();
+}
+
+std::vector<std::pair<double,double>>& SpatialIndex::get_points(){
+    return points;
+}
+
+std::vector<node_int>& SpatialIndex::get_ids(){
+    return ids;
+}
+
+static void query_box_rec(SpatialIndex* index, const double min[2], const double max[2], size_t begin, size_t end, int depth,
+                          std::vector<node_int>& result){
+    if(begin >= end){
+        return;
+    }
+
+    size_t mid = (begin + end) / 2;
+    int axis = depth % 2;
+    const std::pair<double,double>& p = index->get_points()[mid];
+
+    if(p.first >= min[0] && p.first <= max[0] && p.second >= min[1] && p.second <= max[1]){
+        result.push_back(index->get_ids()[mid]);
+    }
+
+    double split = axis_value(p, axis);
+    if(min[axis] <= split){
+        query_box_rec(index, min, max, begin, mid, depth + 1, result);
+    }
+    if(max[axis] >= split){
+        query_box_rec(index, min, max, mid + 1, end, depth + 1, result);
+    }
+}
+
+std::vector<node_int> SpatialIndex::query_box(double min_x, double min_y, double max_x, double max_y){
+    std::vector<node_int> result;
+    const double min[2] = {min_x, min_y};
+    const double max[2] = {max_x, max_y};
+
+    query_box_rec(this, min, max, 0, this->size(), 0, result);
+
+    return result;
+}
+
+static void query_radius_rec(SpatialIndex* index, const double q[2], double r, size_t begin, size_t end, int depth,
+                             std::vector<node_int>& result){
+    if(begin >= end){
+        return;
+    }
+
+    size_t mid = (begin + end) / 2;
+    int axis = depth % 2;
+    const std::pair<double,double>& p = index->get_points()[mid];
+
+    double dx = p.first - q[0];
+    double dy = p.second - q[1];
+    if(dx*dx + dy*dy <= r*r){
+        result.push_back(index->get_ids()[mid]);
+    }
+
+    double split = axis_value(p, axis);
+    if(q[axis] - r <= split){
+        query_radius_rec(index, q, r, begin, mid, depth + 1, result);
+    }
+    if(q[axis] + r >= split){
+        query_radius_rec(index, q, r, mid + 1, end, depth + 1, result);
+    }
+}
+
+std::vector<node_int> SpatialIndex::query_radius(double x, double y, double r){
+    std::vector<node_int> result;
+    const double q[2] = {x, y};
+
+    query_radius_rec(this, q, r, 0, this->size(), 0, result);
+
+    return result;
+}
+
+typedef std::priority_queue<std::pair<double, node_int>> knn_heap;
+
+static void query_nearest_rec(SpatialIndex* index, const double q[2], size_t k, size_t begin, size_t end, int depth, knn_heap& heap){
+    if(begin >= end){
+        return;
+    }
+
+    size_t mid = (begin + end) / 2;
+    int axis = depth % 2;
+    const std::pair<double,double>& p = index->get_points()[mid];
+
+    double dx = p.first - q[0];
+    double dy = p.second - q[1];
+    double dist = dx*dx + dy*dy;
+    if(heap.size() < k){
+        heap.push({dist, index->get_ids()[mid]});
+    }
+    else if(dist < heap.top().first){
+        heap.pop();
+        heap.push({dist, index->get_ids()[mid]});
+    }
+
+    // Descend into the side containing the query first, only visit the other side if it can still hold a closer point.
+    double diff = q[axis] - axis_value(p, axis);
+    size_t near_begin = diff < 0 ? begin : mid + 1;
+    size_t near_end   = diff < 0 ? mid : end;
+    size_t far_begin  = diff < 0 ? mid + 1 : begin;
+    size_t far_end    = diff < 0 ? end : mid;
+
+    query_nearest_rec(index, q, k, near_begin, near_end, depth + 1, heap);
+    if(heap.size() < k || diff*diff < heap.top().first){
+        query_nearest_rec(index, q, k, far_begin, far_end, depth + 1, heap);
+    }
+}
+
+std::vector<node_int> SpatialIndex::query_nearest(double x, double y, size_t k){
+    std::vector<node_int> result;
+    if(k == 0){
+        return result;
+    }
+
+    knn_heap heap;
+    const double q[2] = {x, y};
+    query_nearest_rec(this, q, k, 0, this->size(), 0, heap);
+
+    result.resize(heap.size());
+    for(size_t i = heap.size(); i > 0; i--){
+        result[i - 1] = heap.top().second;
+        heap.pop();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Writes the index next to the layout. It uses the format:
+ *
+ *      [[Type (8 bits)]-[Version (8 bits)]-[Padding (48 bits)]-[Point count (64 bits)]] <- Header
+ *      [[X, Y (2 x 64 bits) per point]-[Ids (node_int per point)]] <- Payload
+ *
+ * The padding keeps the coordinates 8-byte aligned, so python/src/spatial-index.py can map the file and query it
+ * in place. spatial_index_from_bin reads it instead.
+ */
+int spatial_index_to_bin(std::string file_name, SpatialIndex* index){
+    std::string out_name = file_name.substr(0, file_name.size() - 4) + "-spatial.bin";
+    DEBUG_PRINT("Creating spatial index: " + out_name);
+
+    std::ofstream file;
+    file.open(out_name, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "[ERROR] could not open " << out_name << " for writing\n";
+        return 0;
+    }
+
+    uint8_t header[16] = {0};
+    header[0] = 0x01; // type: spatial index
+    header[1] = 0x00; // version
+    uint64_t point_count = index->size();
+    memcpy(header + 8, &point_count, sizeof(uint64_t));
+    file.write((char*)header, sizeof(header));
+
+    std::vector<double> coords(2 * point_count);
+    for(uint64_t i = 0; i < point_count; i++){
+        coords[2*i]     = index->get_points()[i].first;
+        coords[2*i + 1] = index->get_points()[i].second;
+    }
+    file.write((char*)coords.data(), coords.size() * sizeof(double));
+    file.write((char*)index->get_ids().data(), point_count * sizeof(node_int));
+
+    file.close();
+
+    DEBUG_PRINT("Created spatial index: " + out_name);
+    return 1;
+}
+
+/**
+ * @brief Reads an index written by spatial_index_to_bin, nullptr if the file can't be read or isn't one.
+ *
+ * @param       file_name   The path of the '-spatial.bin' file itself
+ */
+SpatialIndex* spatial_index_from_bin(std::string file_name){
+    std::ifstream file(file_name, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "spatial-index.cpp: could not open " << file_name << std::endl;
+        return nullptr;
+    }
+
+    uint8_t header[16];
+    file.read((char*)header, sizeof(header));
+    if(!file || header[0] != 0x01){
+        std::cerr << "spatial-index.cpp: " << file_name << " is not a spatial index" << std::endl;
+        return nullptr;
+    }
+    if(header[1] != 0x00){
+        std::cerr << "spatial-index.cpp: " << file_name << " has the unknown version " << (int)header[1] << std::endl;
+        return nullptr;
+    }
+
+    uint64_t point_count;
+    memcpy(&point_count, header + 8, sizeof(uint64_t));
+
+    // checked against the file before allocating, a broken count could ask for any amount of memory
+    const uint64_t point_bytes = 2 * sizeof(double) + sizeof(node_int);
+    file.seekg(0, std::ios::end);
+    const uint64_t payload_bytes = (uint64_t)file.tellg() - sizeof(header);
+    file.seekg(sizeof(header));
+    if(point_count > payload_bytes / point_bytes){
+        std::cerr << "spatial-index.cpp: " << file_name << " is truncated" << std::endl;
+        return nullptr;
+    }
+
+    std::vector<double> coords(2 * point_count);
+    std::vector<node_int> ids(point_count);
+    file.read((char*)coords.data(), coords.size() * sizeof(double));
+    file.read((char*)ids.data(), point_count * sizeof(node_int));
+    if(!file){
+        std::cerr << "spatial-index.cpp: " << file_name << " is truncated" << std::endl;
+        return nullptr;
+    }
+
+    std::vector<std::pair<double,double>> points(point_count);
+    for(uint64_t i = 0; i < point_count; i++){
+        points[i] = {coords[2*i], coords[2*i + 1]};
+    }
+
+    return new SpatialIndex(points, ids);
+}
@@ -0,0 +1,113 @@
+#include "thread-pool.h"
+#include <algorithm>
+
+// The pool and the deque of the worker running on this thread, if any.
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local unsigned current_index = 0;
+
+ThreadPool::ThreadPool(unsigned thread_nr){
+    if(thread_nr == 0){
+        thread_nr = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for(unsigned i = 0; i <= thread_nr; i++){
+        queues.emplace_back(new task_queue());
+    }
+    for(unsigned i = 0; i < thread_nr; i++){
+        workers.emplace_back([this, i](){ this->work(i); });
+    }
+}
+
+/**
+ * @brief Finishes all queued tasks, then joins the workers.
+ */
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for(std::thread& worker : workers){
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::get_thread_nr(){
+    return workers.size();
+}
+
+ThreadPool* ThreadPool::current(){
+    return current_pool;
+}
+
+void ThreadPool::push(std::function<void()> task){
+    task_queue& queue = current_pool == this ? *queues[current_index] : *queues.back();
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    // counted under the sleep lock, so a worker about to sleep can't miss it
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        pending++;
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::run_one(bool waiting){
+    std::function<void()> task;
+    const unsigned queue_nr = queues.size();
+    const bool is_worker = current_pool == this;
+
+    if(is_worker){
+        task_queue& own = *queues[current_index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.tasks.empty()){
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    // steal the oldest task, going round the deques: outside threads start with the shared one, a worker with the
+    // one in front of its own (the shared one for worker 0)
+    for(unsigned i = 0; !task && !(is_worker && waiting) && i < queue_nr; i++){
+        unsigned victim = is_worker ? (queue_nr - 1 + current_index + i) % queue_nr : (queue_nr - 1 + i) % queue_nr;
+        if(is_worker && victim == current_index){
+            continue;
+        }
+
+        task_queue& queue = *queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty()){
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if(!task){
+        return false;
+    }
+
+    pending--;
+    task();
+    return true;
+}
+
+void ThreadPool::work(unsigned index){
+    current_pool = this;
+    current_index = index;
+
+    while(true){
+        if(run_one()){
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this](){ return stopping || pending > 0; });
+        if(stopping && pending == 0){
+            return;
+        }
+    }
+}
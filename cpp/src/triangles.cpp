@@ -0,0 +1,310 @@
+/**
+ * @brief This file implements the triangle counting and the clustering coefficients derived from it.
+ */
+
+#include "triangles.h"
+#include "thread-pool.h"
+#include "main.h"
+#include "memory-budget.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define TRIANGLES_SSE42
+#endif
+
+// Out-lists longer than this are intersected through a bitmap instead of merged.
+static const size_t BITMAP_MIN_DEGREE = 64;
+// Vertices handed out to a thread at a time, small enough to balance skewed degrees.
+static const node_int VERTEX_CHUNK = 64;
+
+/**
+ * @brief The oriented CSR: only the edges towards the higher (degree, id) end, sorted, without duplicates and self
+ * loops. Also returns the degree of every vertex in the undirected graph underneath.
+ */
+static void orient(Graph* graph, std::vector<edge_int>& offsets, std::vector<node_int>& targets, std::vector<uint32_t>& degrees){
+    const node_int n = graph->get_vertex_nr();
+    auto higher = [graph](node_int v, node_int u){
+        edge_int dv = graph->get_degree(v);
+        edge_int du = graph->get_degree(u);
+        return du > dv || (du == dv && u > v);
+    };
+
+    // count, then fill: an edge stored in both directions (or as a duplicate) lands twice in the same list
+    offsets.assign(n + 1, 0);
+    for(node_int v = 0; v < n; v++){
+        graph->for_each_neighbor(v, [&](node_int u){
+            if(u == v){
+                return;
+            }
+            offsets[(higher(v, u) ? v : u) + 1]++;
+        });
+    }
+    for(node_int v = 0; v < n; v++){
+        offsets[v + 1] += offsets[v];
+    }
+
+    targets.resize(offsets[n]);
+    std::vector<edge_int> fill(offsets.begin(), offsets.end() - 1);
+    for(node_int v = 0; v < n; v++){
+        graph->for_each_neighbor(v, [&](node_int u){
+            if(u == v){
+                return;
+            }
+            if(higher(v, u)){
+                targets[fill[v]++] = u;
+            }
+            else{
+                targets[fill[u]++] = v;
+            }
+        });
+    }
+
+    // sort and compact every list in place
+    edge_int write_index = 0;
+    for(node_int v = 0; v < n; v++){
+        auto begin = targets.begin() + offsets[v];
+        auto end = targets.begin() + offsets[v + 1];
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+
+        offsets[v] = write_index;
+        for(auto it = begin; it != end; it++){
+            targets[write_index++] = *it;
+        }
+    }
+    offsets[n] = write_index;
+    targets.resize(write_index);
+
+    degrees.assign(n, 0);
+    for(node_int v = 0; v < n; v++){
+        for(edge_int i = offsets[v]; i < offsets[v + 1]; i++){
+            degrees[v]++;
+            degrees[targets[i]]++;
+        }
+    }
+}
+
+/**
+ * @brief Scalar merge of two sorted lists, calling f for every common element.
+ */
+template<typename F> static void intersect_scalar(const node_int* a, size_t a_size, const node_int* b, size_t b_size, F f){
+    size_t i = 0, j = 0;
+    while(i < a_size && j < b_size){
+        if(a[i] < b[j]){
+            i++;
+        }
+        else if(a[i] > b[j]){
+            j++;
+        }
+        else{
+            f(a[i]);
+            i++;
+            j++;
+        }
+    }
+}
+
+#ifdef TRIANGLES_SSE42
+/**
+ * @brief Merges 8 ids of both lists per step: _mm_cmpestrm compares every id of a block of a with every id of a block
+ * of b at once (see: Schlegel et al., "Fast Sorted-Set Intersection using SIMD Instructions"). The rest is merged by
+ * intersect_scalar.
+ */
+template<typename F> __attribute__((target("sse4.2")))
+static void intersect_sse42(const node_int* a, size_t a_size, const node_int* b, size_t b_size, F f){
+    const int mode = _SIDD_UWORD_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+    size_t i = 0, j = 0;
+    while(i + 8 <= a_size && j + 8 <= b_size){
+        __m128i block_a = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i block_b = _mm_loadu_si128((const __m128i*)(b + j));
+
+        // bit k is set if a[i + k] occurs in the block of b
+        unsigned mask = _mm_cvtsi128_si32(_mm_cmpestrm(block_b, 8, block_a, 8, mode));
+        while(mask){
+            f(a[i + __builtin_ctz(mask)]);
+            mask &= mask - 1;
+        }
+
+        // the block with the smaller maximum can't match anything further on
+        node_int a_max = a[i + 7];
+        node_int b_max = b[j + 7];
+        if(a_max <= b_max){
+            i += 8;
+        }
+        if(b_max <= a_max){
+            j += 8;
+        }
+    }
+
+    intersect_scalar(a + i, a_size - i, b + j, b_size - j, f);
+}
+
+static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+#endif
+
+template<typename F> static void intersect(const node_int* a, size_t a_size, const node_int* b, size_t b_size, F f){
+#ifdef TRIANGLES_SSE42
+    if(has_sse42){
+        intersect_sse42(a, a_size, b, b_size, f);
+        return;
+    }
+#endif
+    intersect_scalar(a, a_size, b, b_size, f);
+}
+
+triangle_counts count_triangles(Graph* graph, unsigned thread_nr){
+    const node_int n = graph->get_vertex_nr();
+
+    std::vector<edge_int> offsets;
+    std::vector<node_int> targets;
+    std::vector<uint32_t> degrees;
+    orient(graph, offsets, targets, degrees);
+
+    // every thread counts into its own array, merged at the end, so the counting itself needs no atomics
+    std::unique_ptr<ThreadPool> own_pool;
+    ThreadPool* pool = current_or_own_pool(own_pool, thread_nr);
+    const unsigned worker_nr = pool->get_thread_nr();
+    std::vector<std::vector<uint64_t>> local_counts(worker_nr, std::vector<uint64_t>(n, 0));
+    std::atomic<uint32_t> next_vertex(0);
+
+    const int64_t tracked_bytes = offsets.capacity() * sizeof(edge_int) + targets.capacity() * sizeof(node_int)
+                                + degrees.capacity() * sizeof(uint32_t) + (int64_t)worker_nr * n * sizeof(uint64_t);
+    memory_track(MEMORY_TRIANGLES, tracked_bytes);
+
+    std::vector<std::future<void>> done;
+    for(unsigned t = 0; t < worker_nr; t++){
+        done.push_back(pool->submit([&, t](){
+            std::vector<uint64_t>& counts = local_counts[t];
+            std::vector<bool> marked(n, false);
+
+            uint32_t begin;
+            while((begin = next_vertex.fetch_add(VERTEX_CHUNK)) < n){
+                uint32_t end = std::min<uint32_t>(begin + VERTEX_CHUNK, n);
+                for(uint32_t v = begin; v < end; v++){
+                    const node_int* out_v = targets.data() + offsets[v];
+                    const size_t out_v_size = offsets[v + 1] - offsets[v];
+                    const bool use_bitmap = out_v_size >= BITMAP_MIN_DEGREE;
+
+                    if(use_bitmap){
+                        for(size_t i = 0; i < out_v_size; i++){
+                            marked[out_v[i]] = true;
+                        }
+                    }
+
+                    for(size_t i = 0; i < out_v_size; i++){
+                        node_int u = out_v[i];
+                        const node_int* out_u = targets.data() + offsets[u];
+                        const size_t out_u_size = offsets[u + 1] - offsets[u];
+
+                        auto found = [&counts, v, u](node_int w){
+                            counts[v]++;
+                            counts[u]++;
+                            counts[w]++;
+                        };
+                        if(use_bitmap){
+                            for(size_t j = 0; j < out_u_size; j++){
+                                if(marked[out_u[j]]){
+                                    found(out_u[j]);
+                                }
+                            }
+                        }
+                        else{
+                            intersect(out_v, out_v_size, out_u, out_u_size, found);
+                        }
+                    }
+
+                    if(use_bitmap){
+                        for(size_t i = 0; i < out_v_size; i++){
+                            marked[out_v[i]] = false;
+                        }
+                    }
+                }
+            }
+        }));
+    }
+    for(std::future<void>& f : done){
+        pool->wait(f);
+    }
+
+    triangle_counts result;
+    result.per_vertex.assign(n, 0);
+    result.clustering.assign(n, 0.0);
+
+    uint64_t corners = 0;
+    double wedges = 0.0;
+    double clustering_sum = 0.0;
+    for(node_int v = 0; v < n; v++){
+        for(unsigned t = 0; t < worker_nr; t++){
+            result.per_vertex[v] += local_counts[t][v];
+        }
+        corners += result.per_vertex[v];
+
+        double pairs = (double)degrees[v] * (degrees[v] - 1) / 2.0;
+        if(pairs > 0){
+            result.clustering[v] = result.per_vertex[v] / pairs;
+            wedges += pairs;
+        }
+        clustering_sum += result.clustering[v];
+    }
+
+    // every triangle has three corners
+    result.total = corners / 3;
+    result.global_clustering = wedges > 0 ? 3.0 * result.total / wedges : 0.0;
+    result.average_clustering = n > 0 ? clustering_sum / n : 0.0;
+
+    memory_track(MEMORY_TRIANGLES, -tracked_bytes);
+
+    DEBUG_PRINT("Triangles: " + std::to_string(result.total) + ", global clustering: " + std::to_string(result.global_clustering));
+    return result;
+}
+
+/**
+ * @brief Writes the counts in the format:
+ *
+ *      [[Type (8 bits)]-[Version (8 bits)]-[Padding (48 bits)]-[Vertex count (64 bits)]] <- Header
+ *      [[Triangles (64 bits)]-[Global clustering (64 bit double)]-[Average clustering (64 bit double)]] <- Totals
+ *      [[Triangles (64 bits) per vertex]-[Clustering (64 bit double) per vertex]] <- Payload
+ *
+ * The vertices are in the order (and with the ids) of the input file.
+ */
+int clustering_to_bin(std::string file_name, Graph* graph, const triangle_counts& counts){
+    std::string out_name = file_name.substr(0, file_name.size() - 4) + "-clustering.bin";
+    DEBUG_PRINT("Creating clustering: " + out_name);
+
+    std::ofstream file;
+    file.open(out_name, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "[ERROR] could not open " << out_name << " for writing\n";
+        return 0;
+    }
+
+    const uint64_t vertex_count = graph->get_vertex_nr();
+    uint8_t header[16] = {0};
+    header[0] = 0x03; // type: clustering
+    header[1] = 0x00; // version
+    memcpy(header + 8, &vertex_count, sizeof(uint64_t));
+    file.write((char*)header, sizeof(header));
+
+    file.write((char*)&counts.total, sizeof(uint64_t));
+    file.write((char*)&counts.global_clustering, sizeof(double));
+    file.write((char*)&counts.average_clustering, sizeof(double));
+
+    std::vector<uint64_t> triangles(vertex_count);
+    std::vector<double> clustering(vertex_count);
+    for(node_int v = 0; v < vertex_count; v++){
+        triangles[graph->get_original_id(v)] = counts.per_vertex[v];
+        clustering[graph->get_original_id(v)] = counts.clustering[v];
+    }
+    file.write((char*)triangles.data(), vertex_count * sizeof(uint64_t));
+    file.write((char*)clustering.data(), vertex_count * sizeof(double));
+
+    file.close();
+
+    DEBUG_PRINT("Created clustering: " + out_name);
+    return 1;
+}
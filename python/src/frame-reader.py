@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Reader and player for the '-frames.bin' layout recordings written by the C++ backend (fdl::RECORD_FRAMES).
+
+Usage:
+  python frame-reader.py data/data_set-frames.bin                           # print a summary
+  python frame-reader.py data/data_set-frames.bin data/data_set1-fdl.json   # play back, drawing edges and labels
+"""
+
+import sys
+import numpy as np
+
+HEADER_SIZE = 16
+FRAME_HEADER_SIZE = 12
+FRAMES_TYPE = 0x02
+
+FRAME_FLOAT32 = 0
+FRAME_FLOAT16 = 1
+FRAME_DELTA16 = 2
+
+ITEM_TYPES = {
+    FRAME_FLOAT32: np.float32,
+    FRAME_FLOAT16: np.float16,
+    FRAME_DELTA16: np.int16,
+}
+
+
+def read_frames(path):
+    """
+    Returns (stride, iterations, frames) with frames of shape (frame count, node count, 2), indexed by the ids of
+    the input file.
+    """
+    data = np.fromfile(path, dtype=np.uint8)
+    if data[0] != FRAMES_TYPE:
+        raise ValueError(f"{path} is not a frame stream")
+
+    stride = int(data[4:8].view(np.uint32)[0])
+    node_count = int(data[8:16].view(np.uint64)[0])
+
+    iterations = []
+    frames = []
+    current = np.zeros(2 * node_count, dtype=np.float32)
+    offset = HEADER_SIZE
+    while offset + FRAME_HEADER_SIZE <= len(data):
+        iteration = int(data[offset:offset + 4].view(np.uint32)[0])
+        kind = int(data[offset + 4])
+        scale = float(data[offset + 8:offset + 12].view(np.float32)[0])
+        offset += FRAME_HEADER_SIZE
+
+        item_type = ITEM_TYPES[kind]
+        size = 2 * node_count * np.dtype(item_type).itemsize
+        values = data[offset:offset + size].view(item_type)
+        offset += size
+
+        if kind == FRAME_DELTA16:
+            # the writer quantises against the reconstructed frame, so accumulating in float32 matches it exactly
+            current = current + values.astype(np.float32) * np.float32(scale)
+        else:
+            current = values.astype(np.float32)
+
+        iterations.append(iteration)
+        frames.append(current.reshape(node_count, 2))
+
+    return stride, iterations, np.array(frames)
+
+
+def play(iterations, frames, json_path):
+    import json
+    import matplotlib.pyplot as plt
+    from matplotlib.animation import FuncAnimation
+    from matplotlib.collections import LineCollection
+
+    with open(json_path, "r") as f:
+        data = json.load(f)
+
+    # only draw what the JSON shows (isolated nodes are usually hidden)
+    ids = np.array([node["id"] for node in data["nodes"]])
+    labels = [node.get("label", "") for node in data["nodes"]]
+    unique_labels = sorted(set(labels), key=lambda x: str(x))
+    colors = [unique_labels.index(lbl) for lbl in labels]
+    edges = np.array([(edge["source"], edge["target"]) for edge in data["edges"]])
+
+    fig, ax = plt.subplots(figsize=(10, 8))
+    lines = LineCollection([], colors="#dddddd", linewidths=0.5, zorder=1)
+    ax.add_collection(lines)
+    scatter = ax.scatter(frames[0][ids, 0], frames[0][ids, 1], c=colors, cmap="coolwarm", s=10, zorder=2)
+
+    shown = frames[:, ids]
+    ax.set_xlim(shown[..., 0].min(), shown[..., 0].max())
+    ax.set_ylim(shown[..., 1].min(), shown[..., 1].max())
+
+    def update(i):
+        frame = frames[i]
+        scatter.set_offsets(frame[ids])
+        if len(edges):
+            lines.set_segments(np.stack([frame[edges[:, 0]], frame[edges[:, 1]]], axis=1))
+        ax.set_title(f"Iteration {iterations[i]}")
+        return scatter, lines
+
+    animation = FuncAnimation(fig, update, frames=len(frames), interval=50, blit=False)
+    plt.show()
+    return animation
+
+
+def main(argv: list[str]) -> int:
+    if len(argv) < 1:
+        print(__doc__, file=sys.stderr)
+        return 1
+
+    stride, iterations, frames = read_frames(argv[0])
+    print("stride:", stride)
+    print("frames:", len(frames))
+    print("nodes:", frames.shape[1] if len(frames) else 0)
+    print("iterations:", iterations)
+
+    if len(argv) > 1:
+        play(iterations, frames, argv[1])
+
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -1,5 +1,7 @@
 import sys
+import os
 import json
+import importlib.util
 import matplotlib.pyplot as plt
 import networkx as nx
 import matplotlib.patches as mpatches
@@ -12,6 +14,14 @@ else:
     print("Error: no JSON path provided.\nUsage: python graph_explorer.py path/to/your.json", file=sys.stderr)
     sys.exit(1)
 
+# Optional '-spatial.bin' written next to the layout, used for picking nodes with the mouse
+index = None
+if len(sys.argv) > 2:
+    spec = importlib.util.spec_from_file_location("spatial_index", os.path.join(os.path.dirname(__file__), "spatial-index.py"))
+    spatial_index = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(spatial_index)
+    index = spatial_index.SpatialIndex(sys.argv[2])
+
 # Load your JSON
 with open(json_path, "r") as f:
     data = json.load(f)
@@ -76,4 +86,14 @@ for lbl in unique_labels:
 plt.legend(handles=legend_patches, title="label", bbox_to_anchor=(1.05, 1), loc="upper left")
 plt.title("Graph Colored by Label")
 plt.tight_layout()
+
+if index is not None:
+    def on_click(event):
+        if event.xdata is None or event.ydata is None:
+            return
+        for node_id in index.query_nearest(event.xdata, event.ydata, 1):
+            print(f"node {node_id}: label={labels.get(node_id, '')}, neighbours={ranks.get(node_id, 0)}")
+
+    plt.gcf().canvas.mpl_connect("button_press_event", on_click)
+
 plt.show()
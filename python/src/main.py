@@ -11,8 +11,14 @@ def main(argv: list[str]) -> int:
         node_count      = int(np.fromfile(file, dtype=np.uint64, count=1)[0])
         edge_count      = int(np.fromfile(file, dtype=np.uint64, count=1)[0])
 
-        offsets = np.fromfile(file, dtype=np.int32, count=node_count + 1)
-        targets = np.fromfile(file, dtype=np.int32, count=edge_count)
+        if version_block == 0x02:
+            # compressed: the byte offset of every list, then the varint stream (see CompressedAdjacency)
+            offsets = np.fromfile(file, dtype=np.uint64, count=node_count + 1)
+            byte_count = int(np.fromfile(file, dtype=np.uint64, count=1)[0])
+            targets = np.fromfile(file, dtype=np.uint8, count=byte_count)
+        else:
+            offsets = np.fromfile(file, dtype=np.uint64, count=node_count + 1)
+            targets = np.fromfile(file, dtype=np.uint16, count=edge_count)
     
     print("type:", type_block)
     print("version:", version_block)
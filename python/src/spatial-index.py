@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Reader for the '-spatial.bin' k-d tree written next to the layout by the C++ backend.
+
+The file is mapped, not loaded, so opening it is O(1) and every query only touches the pages it visits.
+The tree is implicit: for a range [begin, end) the splitting point is at (begin + end) // 2 and splits along
+x on even depths and along y on odd depths.
+
+Usage:
+  python spatial-index.py data/data_set-spatial.bin box 0 0 10 10
+  python spatial-index.py data/data_set-spatial.bin radius 0 0 5
+  python spatial-index.py data/data_set-spatial.bin nearest 0 0 3
+"""
+
+import sys
+import heapq
+import numpy as np
+
+HEADER_SIZE = 16
+SPATIAL_TYPE = 0x01
+
+
+class SpatialIndex:
+    def __init__(self, path):
+        header = np.fromfile(path, dtype=np.uint8, count=HEADER_SIZE)
+        if header[0] != SPATIAL_TYPE:
+            raise ValueError(f"{path} is not a spatial index")
+
+        self.count = int(header[8:16].view(np.uint64)[0])
+        self.points = np.memmap(path, dtype=np.float64, mode="r", offset=HEADER_SIZE, shape=(self.count, 2))
+        self.ids = np.memmap(path, dtype=np.uint16, mode="r", offset=HEADER_SIZE + self.count * 16, shape=(self.count,))
+
+    def query_box(self, min_x, min_y, max_x, max_y):
+        lo = (min_x, min_y)
+        hi = (max_x, max_y)
+        result = []
+        stack = [(0, self.count, 0)]
+        while stack:
+            begin, end, depth = stack.pop()
+            if begin >= end:
+                continue
+            mid = (begin + end) // 2
+            axis = depth % 2
+            x, y = self.points[mid]
+            if min_x <= x <= max_x and min_y <= y <= max_y:
+                result.append(int(self.ids[mid]))
+            split = self.points[mid, axis]
+            if lo[axis] <= split:
+                stack.append((begin, mid, depth + 1))
+            if hi[axis] >= split:
+                stack.append((mid + 1, end, depth + 1))
+        return result
+
+    def query_radius(self, x, y, r):
+        q = (x, y)
+        result = []
+        stack = [(0, self.count, 0)]
+        while stack:
+            begin, end, depth = stack.pop()
+            if begin >= end:
+                continue
+            mid = (begin + end) // 2
+            axis = depth % 2
+            px, py = self.points[mid]
+            if (px - x) ** 2 + (py - y) ** 2 <= r * r:
+                result.append(int(self.ids[mid]))
+            split = self.points[mid, axis]
+            if q[axis] - r <= split:
+                stack.append((begin, mid, depth + 1))
+            if q[axis] + r >= split:
+                stack.append((mid + 1, end, depth + 1))
+        return result
+
+    def query_nearest(self, x, y, k=1):
+        """Returns the ids of the k nearest nodes, closest first."""
+        q = (x, y)
+        heap = []  # max-heap on distance via negation
+        self._nearest_rec(q, k, 0, self.count, 0, heap)
+        return [node_id for _, node_id in sorted((-d, i) for d, i in heap)]
+
+    def _nearest_rec(self, q, k, begin, end, depth, heap):
+        if begin >= end or k <= 0:
+            return
+        mid = (begin + end) // 2
+        axis = depth % 2
+        px, py = self.points[mid]
+        dist = (px - q[0]) ** 2 + (py - q[1]) ** 2
+        if len(heap) < k:
+            heapq.heappush(heap, (-dist, int(self.ids[mid])))
+        elif dist < -heap[0][0]:
+            heapq.heapreplace(heap, (-dist, int(self.ids[mid])))
+
+        diff = q[axis] - self.points[mid, axis]
+        near, far = ((begin, mid), (mid + 1, end)) if diff < 0 else ((mid + 1, end), (begin, mid))
+        self._nearest_rec(q, k, near[0], near[1], depth + 1, heap)
+        if len(heap) < k or diff * diff < -heap[0][0]:
+            self._nearest_rec(q, k, far[0], far[1], depth + 1, heap)
+
+
+def main(argv: list[str]) -> int:
+    if len(argv) < 2:
+        print(__doc__, file=sys.stderr)
+        return 1
+
+    index = SpatialIndex(argv[0])
+    query = argv[1]
+    args = [float(a) for a in argv[2:]]
+
+    if query == "box":
+        print(index.query_box(*args))
+    elif query == "radius":
+        print(index.query_radius(*args))
+    elif query == "nearest":
+        print(index.query_nearest(args[0], args[1], int(args[2]) if len(args) > 2 else 1))
+    else:
+        print(f"Error: unknown query '{query}'", file=sys.stderr)
+        return 1
+
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,26 @@
+@echo off
+REM compile-python.bat
+
+REM Compile the Python module graph_explorer into python\src, from all cpp files in cpp/src except main.cpp
+setlocal enabledelayedexpansion
+
+set SOURCES=
+for %%f in (cpp\src\*.cpp) do (
+    if /I not "%%~nxf"=="main.cpp" set SOURCES=!SOURCES! %%f
+)
+
+for /f "delims=" %%i in ('python -c "import sysconfig; print(sysconfig.get_paths()['include'])"') do set PYTHON_INCLUDE=%%i
+for /f "delims=" %%i in ('python -c "import sys, os; print(os.path.join(sys.base_prefix, 'libs'))"') do set PYTHON_LIBS=%%i
+for /f "delims=" %%i in ('python -c "import sys; print('python%%d%%d' %% sys.version_info[:2])"') do set PYTHON_LIB=%%i
+for /f "delims=" %%i in ('python -c "import numpy; print(numpy.get_include())"') do set NUMPY_INCLUDE=%%i
+
+g++ -O2 -shared -std=c++17 -Wall -pthread -Icpp\include -I"%PYTHON_INCLUDE%" -I"%NUMPY_INCLUDE%" cpp\python\graph-explorer.cpp %SOURCES% -L"%PYTHON_LIBS%" -l%PYTHON_LIB% -o python\src\graph_explorer.pyd
+
+if %errorlevel% neq 0 (
+    echo.
+    echo Build failed.
+    exit /b %errorlevel%
+)
+
+echo.
+echo Build complete. Use "import graph_explorer" from python\src
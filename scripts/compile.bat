@@ -2,7 +2,7 @@
 REM compile.bat
 
 REM Compile all cpp files in cpp/src with headers in cpp/include
-g++ cpp\src\*.cpp -Icpp\include -std=c++17 -Wall -o program.exe
+g++ cpp\src\*.cpp -Icpp\include -std=c++17 -Wall -pthread -o program.exe
 
 if %errorlevel% neq 0 (
     echo.